@@ -0,0 +1,116 @@
+#ifndef AOT_H
+#define AOT_H
+
+// Runtime side of the ahead-of-time recompiler (src/recompiler.c), enabled with
+// AOT=<generated.c>, which implies BLOCK_CACHE.
+// The generated file has one function per basic block reachable in the ROM. Each
+// one runs the block exactly like block_interpret(), but with the handlers, PCs and
+// immediates known at compile time, so the compiler can inline and specialize them.
+// Each block is attached to the matching block cache entry when that entry is built.
+// Blocks without a translation fall back to the JIT or the block interpreter: RAM
+// code, code only reachable through computed jumps, and the boot ROM.
+//
+// The translation is only used when the loaded ROM hashes to the one it was
+// generated from. Only included by block_cache.h.
+
+#include "util.h"
+
+typedef uint16_t (*AotFunction)(Cpu* cpu, Interconnect* interconnect);
+
+typedef struct AotBlock_t {
+	uint16_t start;
+	uint16_t bank;
+	uint8_t count;        // Instructions, must match the block cache decoding
+	AotFunction function;
+} AotBlock;
+
+// Start of a block, see block_interpret()
+#define AOT_BEGIN() \
+	interconnect->block_exit = 0
+
+// Any instruction but the last one of a block
+#define AOT_STEP(pc, handler, value, prefix, length, cycles) \
+	cpu->reg_pc = (pc) + (prefix); \
+	cpu->operand = (value); \
+	handler(cpu); \
+	cpu->reg_pc += (length); \
+	cpu->instruction_count++; \
+	if (interconnect->block_exit){ \
+		cpu->cycles_left = (cycles); \
+		return (pc); \
+	} \
+	interconnect->scheduler.now += (cycles) * 4
+
+// Last instruction, its cycles are left to the run loop
+#define AOT_LAST(pc, handler, value, prefix, length, cycles) \
+	cpu->reg_pc = (pc) + (prefix); \
+	cpu->operand = (value); \
+	if (!handler(cpu)){ \
+		cpu->reg_pc += (length); \
+	} \
+	if (cpu->cycles_left == 0){ \
+		cpu->cycles_left = (cycles); \
+	} \
+	cpu->instruction_count++; \
+	return (pc)
+
+// Defines AOT_ROM_HASH, aot_blocks[] (sorted by start) and the block functions
+#include AOT_SOURCE
+
+#define AOT_BLOCK_COUNT (sizeof(aot_blocks) / sizeof(aot_blocks[0]))
+
+// Enables the translation if the cartridge in memory is the one it was made from
+static void aot_attach(Cpu* cpu){
+#ifdef DEBUG
+	// Recompiled blocks bypass instruction tracing
+	cpu->aot_enabled = 0;
+#else
+	Interconnect* interconnect = cpu->interconnect;
+	cpu->aot_enabled = hash_bytes(interconnect->rom, interconnect->rom_size) == AOT_ROM_HASH;
+	if (!cpu->aot_enabled){
+		fprintf(stderr, "AOT: ROM does not match the recompiled image, using the interpreter\n");
+	}
+#endif
+}
+
+static AotFunction aot_lookup(uint16_t bank, uint16_t start, uint8_t count){
+	size_t low = 0;
+	size_t high = AOT_BLOCK_COUNT;
+
+	while (low < high){
+		size_t middle = (low + high) / 2;
+		const AotBlock* block = &aot_blocks[middle];
+		if (block->start == start && block->bank == bank){
+			return block->count == count ? block->function : NULL;
+		}
+		if (block->start < start || (block->start == start && block->bank < bank)){
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return NULL;
+}
+
+static Block* block_chain(Cpu* cpu, uint16_t pc);
+
+// Runs a recompiled block, chaining into the following ones like jit_run()
+static uint16_t aot_run(Cpu* cpu, Block* block){
+	Interconnect* interconnect = cpu->interconnect;
+	Scheduler* scheduler = &interconnect->scheduler;
+
+	while (1){
+		uint16_t pc = block->aot(cpu, interconnect);
+
+		Block* next = block_chain(cpu, pc);
+		if (!next || !next->aot){
+			return pc;
+		}
+
+		scheduler->now += cpu->cycles_left * 4;
+		cpu->cycles_left = 0;
+		block = next;
+	}
+}
+
+#endif /* AOT_H */
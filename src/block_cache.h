@@ -0,0 +1,280 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+// Pre-decoded basic block cache, enabled at build time with BLOCK_CACHE=1.
+// A block is a run of straight-line instructions ending at the first control
+// flow change (jump, call, return, restart), HALT/STOP, EI/DI or the block size
+// limit. Opcodes are resolved to handlers and immediates are extracted once, so
+// executing a cached block skips the fetch/decode through read_from_ram.
+//
+// Blocks are keyed by (bank, address), the bank being the ROM bank mapped at the
+// address. ROM never changes, so ROM blocks stay valid forever. They never cross
+// a 16K boundary, past which another bank may be mapped. Blocks built from RAM
+// never cross a page boundary and record the page generation: their pages are
+// taken off the direct write map and any write to them bumps the generation,
+// invalidating every block in that page.
+//
+// Only included by cpu.c, which owns the Instruction tables.
+
+#define BLOCK_CACHE_ENTRIES 2048      // Direct mapped, must be a power of two
+#define BLOCK_MAX_INSTRUCTIONS 16
+
+// Code banks used in block keys
+#define BLOCK_BANK_BIOS 0xFFFE        // Boot ROM overlay of page 0
+#define BLOCK_BANK_RAM  0xFFFF        // Anything above 0x8000
+
+typedef struct DecodedInstruction_t {
+	int8_t (*execute)(Cpu*);
+	uint16_t opcode;     // Fused opcode (CB_PREFIX | opcode for CB instructions)
+	uint16_t operand;    // Immediate value, already read from memory
+	uint8_t prefix;      // 1 for CB instructions: PC skips the prefix before executing
+	uint8_t length;      // Operand length + 1, not counting the prefix
+	uint8_t cycles;      // Default M-cycles
+} DecodedInstruction;
+
+typedef struct Block_t {
+	uint16_t start;
+	uint16_t bank;
+	uint32_t generation;  // Page generation at build time (RAM blocks)
+	uint16_t cycles;      // M-cycles of all instructions but the last one
+	uint8_t count;        // Number of instructions, 0 when the slot is empty
+#ifdef JIT
+	uint8_t hits;         // Executions before translation
+	uint8_t* native;      // Translated code, NULL until the block is hot
+#endif
+#ifdef AOT
+	uint16_t (*aot)(Cpu*, struct Interconnect_t*);  // Recompiled function, see aot.h
+#endif
+	DecodedInstruction instructions[BLOCK_MAX_INSTRUCTIONS];
+} Block;
+
+typedef struct BlockCache_t {
+	Block blocks[BLOCK_CACHE_ENTRIES];
+} BlockCache;
+
+#ifdef AOT
+#include "aot.h"
+#endif
+
+static inline uint16_t block_code_bank(Interconnect* interconnect, uint16_t addr){
+	if (addr < 0x100 && interconnect->inBios){
+		return BLOCK_BANK_BIOS;
+	}
+	if (addr < 0x8000){
+		// ROM bank currently mapped there, see mbc.h
+		return addr < ROM_BANK_SIZE ? interconnect->mbc.bank_low : interconnect->mbc.bank_high;
+	}
+	return BLOCK_BANK_RAM;
+}
+
+static inline uint16_t block_read_operand(Interconnect* interconnect, uint16_t addr, int8_t length){
+	switch (length){
+		case 1: return read_from_ram(interconnect, addr);
+		case 2: return read_addr_from_ram(interconnect, addr);
+		default: return 0;
+	}
+}
+
+// Decodes the block starting at the current PC into the given slot
+static void block_build(Cpu* cpu, Block* block, uint16_t bank){
+	Interconnect* interconnect = cpu->interconnect;
+	uint16_t start = cpu->reg_pc;
+	uint16_t pc = start;
+	int in_ram = bank == BLOCK_BANK_RAM;
+
+	block->start = start;
+	block->bank = bank;
+	block->generation = interconnect->page_generation[canonical_page(start >> 8)];
+	block->cycles = 0;
+	block->count = 0;
+#ifdef JIT
+	block->hits = 0;
+	block->native = NULL;
+#endif
+#ifdef AOT
+	block->aot = NULL;
+#endif
+
+	while (block->count < BLOCK_MAX_INSTRUCTIONS){
+		if (pc >= 0xFF00 && pc < 0xFF80){
+			break;  // Never cache code running from I/O registers
+		}
+
+		uint8_t opcode = read_from_ram(interconnect, pc);
+		uint8_t prefix = 0;
+		const Instruction* instruction = &instructions[opcode];
+
+		if (opcode == 0xCB){
+			prefix = 1;
+			instruction = &cb_instructions[read_from_ram(interconnect, pc + 1)];
+		}
+
+		if (!instruction->execute){
+			break;  // Left to run_instruction, which reports it
+		}
+
+		uint16_t length = prefix + instruction->parLength + 1;
+		if (in_ram && ((pc + length - 1) >> 8) != (start >> 8)){
+			break;  // Would reach into the next page
+		}
+		if (!in_ram && ((pc + length - 1) / ROM_BANK_SIZE) != (start / ROM_BANK_SIZE)){
+			break;  // Would reach into memory the block's bank does not cover
+		}
+
+		DecodedInstruction* decoded = &block->instructions[block->count];
+		decoded->execute = instruction->execute;
+		decoded->opcode = prefix ? (CB_PREFIX | read_from_ram(interconnect, pc + 1)) : opcode;
+		decoded->operand = block_read_operand(interconnect, pc + prefix + 1, instruction->parLength);
+		decoded->prefix = prefix;
+		decoded->length = instruction->parLength + 1;
+		decoded->cycles = instruction->cycles;
+
+		if (block->count > 0){
+			block->cycles += block->instructions[block->count - 1].cycles;
+		}
+		block->count++;
+		pc += length;
+
+		if (!prefix && block_ends_with(opcode)){
+			break;
+		}
+	}
+
+	if (in_ram && block->count > 0 && !interconnect->code_page[canonical_page(start >> 8)]){
+		// Writes to this page, through any of its addresses, must now go through
+		// the slow path to invalidate it
+		interconnect->code_page[canonical_page(start >> 8)] = 1;
+		rebuild_memory_map(interconnect);
+	}
+
+#ifdef AOT
+	if (!in_ram && cpu->aot_enabled){
+		block->aot = aot_lookup(bank, start, block->count);
+	}
+#endif
+}
+
+static inline Block* block_lookup(Cpu* cpu){
+	Interconnect* interconnect = cpu->interconnect;
+	uint16_t pc = cpu->reg_pc;
+	uint16_t bank = block_code_bank(interconnect, pc);
+	Block* block = &cpu->block_cache->blocks[(pc ^ (bank << 7)) & (BLOCK_CACHE_ENTRIES - 1)];
+
+	if (block->count == 0 || block->start != pc || block->bank != bank ||
+	    block->generation != interconnect->page_generation[canonical_page(pc >> 8)]){
+		block_build(cpu, block, bank);
+	}
+	return block;
+}
+
+// Same semantics as one pass through run_instruction for a decoded instruction
+static inline void block_execute_instruction(Cpu* cpu, DecodedInstruction* decoded){
+	cpu->reg_pc += decoded->prefix;
+	cpu->operand = decoded->operand;
+
+#ifdef DEBUG
+	trace_instruction(cpu, decoded->prefix ? &cb_instructions[decoded->opcode & 0xFF] : &instructions[decoded->opcode]);
+#endif
+
+#ifdef SWITCH_CORE
+	execute_fused(cpu, decoded->opcode);
+#else
+	int8_t jmp_occured = decoded->execute(cpu);
+	if (cpu->cycles_left == 0){
+		cpu->cycles_left = decoded->cycles;
+	}
+	if (!jmp_occured){
+		cpu->reg_pc += decoded->length;
+	}
+#endif
+
+	cpu->instruction_count++;
+}
+
+// Executes a whole block. Time is advanced for every instruction except the last one,
+// whose cycles are left in cycles_left for the run loop. Returns the PC of the last
+// instruction executed.
+static uint16_t block_interpret(Cpu* cpu, Block* block){
+	Interconnect* interconnect = cpu->interconnect;
+	Scheduler* scheduler = &interconnect->scheduler;
+	uint16_t pc;
+
+	// Set by writes that may wake an interrupt, reschedule an event or modify this block
+	interconnect->block_exit = 0;
+
+	for (int i = 0; ; i++){
+		pc = cpu->reg_pc;
+		block_execute_instruction(cpu, &block->instructions[i]);
+
+		if (i == block->count - 1 || interconnect->block_exit){
+			return pc;
+		}
+
+		scheduler->now += cpu->cycles_left * 4;
+		cpu->cycles_left = 0;
+	}
+}
+
+// After a compiled block returned pc, looks up the next block if the run loop would
+// have nothing to do at this boundary besides advancing time: no early exit, no
+// HALT/EI, no pending interrupt, no idle loop candidate, and the next block fits
+// before the next event. The caller still has to account the last instruction.
+static Block* block_chain(Cpu* cpu, uint16_t pc){
+	Interconnect* interconnect = cpu->interconnect;
+	Scheduler* scheduler = &interconnect->scheduler;
+
+	if (interconnect->block_exit || cpu->halted || cpu->ime_scheduled ||
+	    (interconnect->interrupt_flag & interconnect->interrupt_enable & 0x1F) ||
+	    (uint16_t)(pc - cpu->reg_pc) <= IDLE_LOOP_MAX_BYTES){
+		return NULL;
+	}
+
+	Block* next = block_lookup(cpu);
+	if (next->count == 0 || scheduler->now + (cpu->cycles_left + next->cycles) * 4 >= scheduler->next_deadline){
+		return NULL;
+	}
+	return next;
+}
+
+#ifdef JIT
+#include "jit.h"
+#endif
+
+// Runs the block at PC, or a single instruction when no block fits before the next
+// event. Returns the PC of the last instruction executed, see block_interpret().
+static uint16_t run_block(Cpu* cpu){
+	Scheduler* scheduler = &cpu->interconnect->scheduler;
+	uint16_t pc = cpu->reg_pc;
+
+	// During OAM DMA code outside 0xFF00-0xFFFF reads as 0xFF and must not be decoded
+	if (cpu->interconnect->dma_active){
+		run_instruction(cpu);
+		return pc;
+	}
+
+	Block* block = block_lookup(cpu);
+
+	if (block->count == 0 || scheduler->now + block->cycles * 4 >= scheduler->next_deadline){
+		run_instruction(cpu);
+		return pc;
+	}
+
+#ifdef AOT
+	if (block->aot){
+		return aot_run(cpu, block);
+	}
+#endif
+
+#ifdef JIT
+	if (!block->native && block->hits < JIT_HOT_THRESHOLD && ++block->hits == JIT_HOT_THRESHOLD){
+		jit_compile(cpu, block);
+	}
+	if (block->native){
+		return jit_run(cpu, block);
+	}
+#endif
+
+	return block_interpret(cpu, block);
+}
+
+#endif /* BLOCK_CACHE_H */
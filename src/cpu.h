@@ -8,6 +8,15 @@
 #define FLAG_BIT_C 0x4
 #define FLAG_NONE 0x0
 
+// Deferred flag operations (LAZY_FLAGS builds only)
+#define FLAGOP_NONE 0  // reg_f is up to date
+#define FLAGOP_ADD  1  // ADD/ADC: Z, N=0, H and C from lhs + rhs + carry
+#define FLAGOP_SUB  2  // SUB/SBC/CP: Z, N=1, H and C from lhs - rhs - carry
+#define FLAGOP_AND  3  // AND: Z, N=0, H=1, C=0
+#define FLAGOP_OR   4  // OR/XOR: Z, N=0, H=0, C=0
+#define FLAGOP_INC  5  // INC r: Z, N=0, H, C unchanged
+#define FLAGOP_DEC  6  // DEC r: Z, N=1, H, C unchanged
+
 #define PC_NO_JMP 0
 #define PC_JMP 1
 
@@ -24,6 +33,16 @@ typedef struct InstructionTrace_t {
 } InstructionTrace;
 
 
+// Idle loop detection state, see idle_loop_check() in cpu.c
+typedef struct IdleLoop_t {
+	uint16_t head;                // Loop head (backward jump target) being watched
+	uint16_t af, bc, de, hl, sp;  // Registers at the start of the watched iteration
+	uint64_t time;                // Timestamp at the start of the watched iteration
+	uint64_t deadline;            // Next event deadline at the start of the watched iteration
+	uint64_t instruction_count;   // Instruction count at the start of the watched iteration
+} IdleLoop;
+
+// Registers and run state first, they share the first cache lines of GameBoy
 typedef struct Cpu_t{
 	struct{
 		union{
@@ -71,16 +90,36 @@ typedef struct Cpu_t{
 	uint8_t ime_scheduled;  // Set to 1 when EI is executed, IME enabled after next instruction
 	uint8_t halted;  // Set to 1 when HALT is executed, CPU waits for interrupt
 	uint8_t in_interrupt;  // Set to 1 when in interrupt handler, for timing adjustments
+	IdleLoop idle_loop;    // Polling loop currently being watched for skipping
+#ifdef BLOCK_CACHE
+	uint16_t operand;      // Immediate of the executing instruction, see get_one_byte_parameter
+	struct BlockCache_t* block_cache;
+#endif
+#ifdef JIT
+	struct Jit_t* jit;
+#endif
+#ifdef AOT
+	uint8_t aot_enabled;   // Set by aot_attach() when the recompiled ROM is loaded
+#endif
+#ifdef LAZY_FLAGS
+	// Last ALU operation whose flags have not been written to reg_f yet
+	uint8_t flag_op;       // FLAGOP_* kind, FLAGOP_NONE when reg_f is current
+	uint8_t flag_lhs;      // First operand
+	uint8_t flag_rhs;      // Second operand
+	uint8_t flag_carry;    // Carry in (ADC/SBC)
+	uint16_t flag_result;  // Unmasked result (carry out in bit 8)
+#endif
 } Cpu;
 
 typedef struct Instruction_t {
-	char *disassembly;
+	const char *disassembly;
 	int8_t parLength;
 	uint8_t cycles;
 	int8_t (*execute)(Cpu*);
 } Instruction;
 
-void initialize_cpu(Cpu** cpu, struct Interconnect_t* interconnect);
+void initialize_cpu(Cpu* cpu, struct Interconnect_t* interconnect);
+void cpu_flush_caches(Cpu* cpu);
 
 void run(Cpu* cpu);
 void* cpu_thread_run(void* arg);
@@ -92,8 +131,32 @@ void add_instruction_to_buffer(uint64_t instruction_count, uint16_t pc, const ch
 void print_instruction_buffer(void);
 #endif
 
-static Instruction instructions[256];
-static Instruction cb_instructions[256];
+// Built at compile time from cpu_opcode_table.h, see cpu.c
+extern const Instruction instructions[256];
+extern const Instruction cb_instructions[256];
+
+const Instruction* lookup_instruction(uint8_t prefix, uint8_t opcode);
+
+// Instructions that end a basic block (block cache, recompiler): everything that
+// writes PC, plus HALT/STOP and the IME changes, which the run loop must see at an
+// instruction boundary
+static inline int block_ends_with(uint8_t opcode){
+	switch (opcode){
+		case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:  // JR
+		case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:  // JP
+		case 0xE9:                                              // JP HL
+		case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC:  // CALL
+		case 0xC9: case 0xC0: case 0xC8: case 0xD0: case 0xD8:  // RET
+		case 0xD9:                                              // RETI
+		case 0xC7: case 0xCF: case 0xD7: case 0xDF:             // RST
+		case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+		case 0x76: case 0x10:                                   // HALT, STOP
+		case 0xF3: case 0xFB:                                   // DI, EI
+			return 1;
+		default:
+			return 0;
+	}
+}
 
 #include "cpu_inline.h"
 
@@ -0,0 +1,67 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Fused switch interpreter core, selected at build time with CORE=switch.
+// Base opcodes occupy 0x000-0x0FF and CB-prefixed opcodes 0x100-0x1FF of a
+// single 512-entry switch. Operand length and M-cycle counts are baked into
+// every case, so no Instruction table lookup or indirect call is needed.
+// Cases are expanded from cpu_opcode_table.h, like the Instruction tables, so
+// both cores produce identical results.
+
+#include "cpu_opcode_table.h"
+
+#define CB_PREFIX 0x100
+
+// Straight-line instruction: fixed length, fixed cycle count
+#define OP_PLAIN(index, handler, length, cycles) \
+	case index: \
+		handler(cpu); \
+		cpu->reg_pc += (length) + 1; \
+		cpu->cycles_left = (cycles); \
+		break;
+
+// Unconditional jump/call/return/restart: handler always sets PC
+#define OP_JUMP(index, handler, length, cycles) \
+	case index: \
+		handler(cpu); \
+		cpu->cycles_left = (cycles); \
+		break;
+
+// Conditional branch: handler sets cycles_left for the taken/not taken case
+#define OP_BRANCH(index, handler, length, cycles) \
+	case index: \
+		if (handler(cpu) == PC_NO_JMP) \
+			cpu->reg_pc += (length) + 1; \
+		break;
+
+#define OP_BASE(opcode, handler, disassembly, length, cycles, kind) \
+	OP_##kind(opcode, handler, length, cycles)
+#define OP_CB(opcode, handler, disassembly, length, cycles, kind) \
+	OP_##kind(CB_PREFIX | (opcode), handler, length, cycles)
+
+static inline void execute_fused(Cpu* cpu, uint16_t opcode){
+	switch(opcode){
+		BASE_OPCODES(OP_BASE)
+		CB_OPCODES(OP_CB)
+
+		default:
+			#ifdef DEBUG
+			print_instruction_buffer();
+			#endif
+			if (opcode & CB_PREFIX){
+				fprintf(stderr, "0x%x: CB prefixed instruction 0x%x not implemented!\n", cpu->reg_pc, opcode & 0xFF);
+			}else
+			{
+				fprintf(stderr, "0x%x: Instruction 0x%x not implemented!\n", cpu->reg_pc, opcode);
+			}
+			exit(-1);
+	}
+}
+
+#undef OP_PLAIN
+#undef OP_JUMP
+#undef OP_BRANCH
+#undef OP_BASE
+#undef OP_CB
+
+#endif /* CPU_DISPATCH_H */
@@ -7,6 +7,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef BLOCK_CACHE
+// Immediates are decoded before the handler runs (block cache or run_instruction)
+static inline uint16_t get_two_byte_parameter(Cpu* cpu){
+	return cpu->operand;
+}
+
+static inline uint8_t get_one_byte_parameter(Cpu* cpu){
+	return (uint8_t)cpu->operand;
+}
+#else
 static inline uint16_t get_two_byte_parameter(Cpu* cpu){
 	uint16_t addr = cpu->reg_pc + 1;
 	return read_addr_from_ram(cpu->interconnect, addr);
@@ -15,12 +25,82 @@ static inline uint16_t get_two_byte_parameter(Cpu* cpu){
 static inline uint8_t get_one_byte_parameter(Cpu* cpu){
 	return read_from_ram(cpu->interconnect, cpu->reg_pc +1);
 }
+#endif
 
 
 static inline void set_bit(uint8_t* x, int bit_num ){
 	*x |= (1L << bit_num);
 }
 
+#ifdef LAZY_FLAGS
+static inline void resolve_flags(Cpu* cpu){
+	// Build Z/N/H/C from the deferred operation, bits not owned by it are kept
+	uint8_t result = (uint8_t)cpu->flag_result;
+	uint8_t lhs = cpu->flag_lhs;
+	uint8_t rhs = cpu->flag_rhs;
+	uint8_t carry = cpu->flag_carry;
+	uint8_t flags = (result == 0) << FLAG_BIT_Z;
+	uint8_t mask = 0xF0;
+
+	switch(cpu->flag_op){
+		case FLAGOP_ADD:
+			flags |= (((lhs & 0x0F) + (rhs & 0x0F) + carry) > 0x0F) << FLAG_BIT_H;
+			flags |= (cpu->flag_result > 0xFF) << FLAG_BIT_C;
+			break;
+		case FLAGOP_SUB:
+			flags |= 1 << FLAG_BIT_N;
+			flags |= (((int)(lhs & 0x0F) - (int)(rhs & 0x0F) - (int)carry) < 0) << FLAG_BIT_H;
+			flags |= (cpu->flag_result > 0xFF) << FLAG_BIT_C;
+			break;
+		case FLAGOP_AND:
+			flags |= 1 << FLAG_BIT_H;
+			break;
+		case FLAGOP_OR:
+			break;
+		case FLAGOP_INC:
+			flags |= ((result & 0x0F) == 0x00) << FLAG_BIT_H;
+			mask = 0xE0;  // C unchanged
+			break;
+		case FLAGOP_DEC:
+			flags |= 1 << FLAG_BIT_N;
+			flags |= ((result & 0x0F) == 0x0F) << FLAG_BIT_H;
+			mask = 0xE0;  // C unchanged
+			break;
+	}
+
+	cpu->reg_f = (cpu->reg_f & ~mask) | flags;
+	cpu->flag_op = FLAGOP_NONE;
+}
+
+static inline void defer_flags(Cpu* cpu, uint8_t op, uint8_t lhs, uint8_t rhs, uint8_t carry, uint16_t result){
+	// INC/DEC keep C, so a pending operation that owns C must land first
+	if ((op == FLAGOP_INC || op == FLAGOP_DEC) &&
+	    cpu->flag_op != FLAGOP_NONE && cpu->flag_op != FLAGOP_INC && cpu->flag_op != FLAGOP_DEC){
+		resolve_flags(cpu);
+	}
+	cpu->flag_op = op;
+	cpu->flag_lhs = lhs;
+	cpu->flag_rhs = rhs;
+	cpu->flag_carry = carry;
+	cpu->flag_result = result;
+}
+#endif
+
+// Brings reg_f up to date. Needed wherever F is read as a whole (PUSH AF,
+// saving state); a no-op unless built with LAZY_FLAGS.
+static inline void sync_flags(Cpu* cpu){
+#ifdef LAZY_FLAGS
+	if (cpu->flag_op != FLAGOP_NONE){
+		resolve_flags(cpu);
+	}
+#endif
+}
+
+static inline uint8_t* cpu_flags(Cpu* cpu){
+	sync_flags(cpu);
+	return &(cpu->reg_f);
+}
+
 static inline int get_bit(uint8_t* x, int bit_num){
 	return ((*x & (1<<(bit_num))));
 }
@@ -43,14 +123,17 @@ static inline void push_stack(Cpu* cpu, uint16_t addr){
 }
 
 static inline void clear_all_flags(Cpu* cpu){
+#ifdef LAZY_FLAGS
+	cpu->flag_op = FLAGOP_NONE;
+#endif
 	cpu->reg_f = FLAG_NONE;
 }
 
 static inline void toggle_flag(Cpu* cpu, uint8_t flag){
-	if( get_bit(&(cpu->reg_f), flag) ){
-		clear_bit( &(cpu->reg_f), flag);
+	if( get_bit(cpu_flags(cpu), flag) ){
+		clear_bit( cpu_flags(cpu), flag);
 	}else{
-		set_bit( &(cpu->reg_f), flag);
+		set_bit( cpu_flags(cpu), flag);
 	}
 }
 
@@ -68,14 +151,14 @@ static inline uint8_t opcodes_rl_rotate(Cpu* cpu, uint8_t* reg){
 	// RL: Rotate left through carry
 	// Old bit 7 -> C flag, C flag -> bit 0
 
-	uint8_t old_carry = get_bit(&(cpu->reg_f), FLAG_BIT_C) ? 1 : 0;
+	uint8_t old_carry = get_bit(cpu_flags(cpu), FLAG_BIT_C) ? 1 : 0;
 	uint8_t result = *reg;
 
 	// Set C flag to old bit 7
 	if ((result & 0x80) != 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Rotate left and insert old carry at bit 0
@@ -84,8 +167,8 @@ static inline uint8_t opcodes_rl_rotate(Cpu* cpu, uint8_t* reg){
 	*reg = result;
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 
 	return result;
 }
@@ -97,13 +180,13 @@ static inline void opcodes_rl(Cpu* cpu, uint8_t* reg){
 	// CB RL r: Z=1 if result is 0, else Z=0
 	if (reg == &(cpu->reg_a)){
 		// RLA - always clear Z flag
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
 		// CB prefixed RL - set Z flag based on result
 		if (result == 0) {
-			set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+			set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 		} else {
-			clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+			clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 		}
 	}
 }
@@ -112,14 +195,14 @@ static inline void opcodes_rr(Cpu* cpu, uint8_t* reg){
 	// RR: Rotate right through carry
 	// Old bit 0 -> C flag, C flag -> bit 7
 
-	uint8_t old_carry = get_bit(&(cpu->reg_f), FLAG_BIT_C) ? 1 : 0;
+	uint8_t old_carry = get_bit(cpu_flags(cpu), FLAG_BIT_C) ? 1 : 0;
 	uint8_t result = *reg;
 
 	// Set C flag to old bit 0
 	if ((result & 0x01) != 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Rotate right and insert old carry at bit 7
@@ -128,14 +211,14 @@ static inline void opcodes_rr(Cpu* cpu, uint8_t* reg){
 	*reg = result;
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 
 	// Set Z flag based on result
 	if (result == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 }
 
@@ -143,233 +226,274 @@ static inline void opcodes_cp(Cpu* cpu, uint8_t number){
 	// CP: Compare A with number (A - number)
 	// Z=1 if A==number, N=1, H=1 if borrow from bit 4, C=1 if A<number
 
-	set_bit(&(cpu->reg_f), FLAG_BIT_N);
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_SUB, cpu->reg_a, number, 0, (uint16_t)(cpu->reg_a - number));
+#else
+	set_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set Z flag if A == number
 	if (cpu->reg_a == number){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Set C flag if A < number (borrow occurred)
 	if (cpu->reg_a < number){
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Set H flag if borrow from bit 4
 	if ((cpu->reg_a & 0x0F) < (number & 0x0F)){
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
+#endif
 }
 
 static inline void cpu_inc_toggle_bits(Cpu* cpu, uint8_t* reg){
 	// INC: Z if result is 0, N=0, H if overflow from bit 3, C unchanged
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_INC, 0, 0, 0, *reg);
+#else
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N flag (INC always clears N)
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set H flag if lower nibble is 0 (overflow from bit 3)
 	if ((*reg & 0x0F) == 0x00) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// C flag is unchanged (don't touch it)
+#endif
 }
 
 static inline void cpu_dec_toggle_bits(Cpu* cpu, uint8_t* reg){
 	// DEC: Z if result is 0, N=1, H if borrow from bit 4, C unchanged
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_DEC, 0, 0, 0, *reg);
+#else
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Set N flag (DEC always sets N)
-	set_bit(&(cpu->reg_f), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set H flag if lower nibble is 0xF (borrow from bit 4)
 	if ((*reg & 0x0F) == 0x0F) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// C flag is unchanged (don't touch it)
+#endif
 }
 
 static inline void opcodes_add(Cpu* cpu, uint8_t value){
 	// ADD: Z if result is 0, N=0, H if carry from bit 3, C if carry from bit 7
 	uint16_t result = cpu->reg_a + value;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_ADD, cpu->reg_a, value, 0, result);
+	cpu->reg_a = (uint8_t)result;
+#else
 	// Set H flag if carry from bit 3 (half carry)
 	if (((cpu->reg_a & 0x0F) + (value & 0x0F)) > 0x0F) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// Set C flag if carry from bit 7 (result > 0xFF)
 	if (result > 0xFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	cpu->reg_a = (uint8_t)result;
 
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N flag (ADD always clears N)
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+#endif
 }
 
 static inline void opcodes_adc(Cpu* cpu, uint8_t value){
 	// ADC: Add with carry - Z if result is 0, N=0, H if carry from bit 3, C if carry from bit 7
-	uint8_t carry = get_bit(&(cpu->reg_f), FLAG_BIT_C) ? 1 : 0;
+	uint8_t carry = get_bit(cpu_flags(cpu), FLAG_BIT_C) ? 1 : 0;
 	uint16_t result = cpu->reg_a + value + carry;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_ADD, cpu->reg_a, value, carry, result);
+	cpu->reg_a = (uint8_t)result;
+#else
 	// Set H flag if carry from bit 3 (half carry)
 	if (((cpu->reg_a & 0x0F) + (value & 0x0F) + carry) > 0x0F) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// Set C flag if carry from bit 7 (result > 0xFF)
 	if (result > 0xFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	cpu->reg_a = (uint8_t)result;
 
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N flag (ADC always clears N)
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+#endif
 }
 
 static inline void opcodes_sub(Cpu* cpu, uint8_t value){
 	// SUB: Z if result is 0, N=1, H if borrow from bit 4, C if borrow occurred (A < value)
 
+#ifdef LAZY_FLAGS
+	uint16_t result = cpu->reg_a - value;
+	defer_flags(cpu, FLAGOP_SUB, cpu->reg_a, value, 0, result);
+	cpu->reg_a = (uint8_t)result;
+#else
 	// Set N flag (SUB always sets N)
-	set_bit(&(cpu->reg_f), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set C flag if borrow occurred (A < value)
 	if (cpu->reg_a < value) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Set H flag if borrow from bit 4
 	if ((cpu->reg_a & 0x0F) < (value & 0x0F)) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	cpu->reg_a -= value;
 
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
+#endif
 }
 
 static inline void opcodes_sbc(Cpu* cpu, uint8_t value){
 	// SBC: Subtract with carry - Z if result is 0, N=1, H if borrow from bit 4, C if borrow occurred
-	uint8_t carry = get_bit(&(cpu->reg_f), FLAG_BIT_C) ? 1 : 0;
+	uint8_t carry = get_bit(cpu_flags(cpu), FLAG_BIT_C) ? 1 : 0;
 	uint16_t result = cpu->reg_a - value - carry;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_SUB, cpu->reg_a, value, carry, result);
+	cpu->reg_a = (uint8_t)result;
+#else
 	// Set N flag (SBC always sets N)
-	set_bit(&(cpu->reg_f), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set C flag if borrow occurred (result < 0, i.e., result > 0xFF when viewed as unsigned)
 	if (result > 0xFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Set H flag if borrow from bit 4
 	if (((int)(cpu->reg_a & 0x0F) - (int)(value & 0x0F) - (int)carry) < 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	cpu->reg_a = (uint8_t)result;
 
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
+#endif
 }
 
 static inline void opcodes_or(Cpu* cpu, uint8_t value){
 	// OR: Z if result is 0, N=0, H=0, C=0
 	cpu->reg_a |= value;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_OR, 0, 0, 0, cpu->reg_a);
+#else
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N, H, C flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_C);
+#endif
 }
 
 static inline void opcodes_and(Cpu* cpu, uint8_t value){
 	// AND: Z if result is 0, N=0, H=1, C=0
 	cpu->reg_a &= value;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_AND, 0, 0, 0, cpu->reg_a);
+#else
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and C flags, set H flag
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_C);
+#endif
 }
 
 static inline void opcodes_swap(Cpu* cpu, uint8_t* reg){
@@ -379,15 +503,15 @@ static inline void opcodes_swap(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N, H, C flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 }
 
 static inline void opcodes_srl(Cpu* cpu, uint8_t* reg){
@@ -396,9 +520,9 @@ static inline void opcodes_srl(Cpu* cpu, uint8_t* reg){
 
 	// Set C flag to old bit 0
 	if ((*reg & 0x01) != 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Shift right, bit 7 becomes 0
@@ -406,14 +530,14 @@ static inline void opcodes_srl(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 }
 
 static inline void opcodes_sla(Cpu* cpu, uint8_t* reg){
@@ -422,9 +546,9 @@ static inline void opcodes_sla(Cpu* cpu, uint8_t* reg){
 
 	// Set C flag to old bit 7
 	if ((*reg & 0x80) != 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Shift left, bit 0 becomes 0
@@ -432,31 +556,35 @@ static inline void opcodes_sla(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 }
 
 static inline void opcodes_xor(Cpu* cpu, uint8_t value){
 	// XOR: Z if result is 0, N=0, H=0, C=0
 	cpu->reg_a ^= value;
 
+#ifdef LAZY_FLAGS
+	defer_flags(cpu, FLAGOP_OR, 0, 0, 0, cpu->reg_a);
+#else
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N, H, C flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_C);
+#endif
 }
 
 static inline void opcodes_add_hl(Cpu* cpu, uint16_t value){
@@ -465,22 +593,22 @@ static inline void opcodes_add_hl(Cpu* cpu, uint16_t value){
 
 	// Set H flag if carry from bit 11 (half carry for 16-bit)
 	if (((cpu->reg_hl & 0x0FFF) + (value & 0x0FFF)) > 0x0FFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// Set C flag if carry from bit 15 (result > 0xFFFF)
 	if (result > 0xFFFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	cpu->reg_hl = (uint16_t)result;
 
 	// Clear N flag (ADD always clears N)
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Z flag is unchanged (don't touch it)
 }
@@ -493,9 +621,9 @@ static inline void opcodes_rlc(Cpu* cpu, uint8_t* reg){
 
 	// Set C flag to old bit 7
 	if (bit7) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Rotate left, bit 7 goes to bit 0
@@ -503,14 +631,14 @@ static inline void opcodes_rlc(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 }
 
 static inline void opcodes_rrc(Cpu* cpu, uint8_t* reg){
@@ -521,9 +649,9 @@ static inline void opcodes_rrc(Cpu* cpu, uint8_t* reg){
 
 	// Set C flag to old bit 0
 	if (bit0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Rotate right, bit 0 goes to bit 7
@@ -531,14 +659,14 @@ static inline void opcodes_rrc(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 }
 
 static inline void opcodes_sra(Cpu* cpu, uint8_t* reg){
@@ -549,9 +677,9 @@ static inline void opcodes_sra(Cpu* cpu, uint8_t* reg){
 
 	// Set C flag to old bit 0
 	if ((*reg & 0x01) != 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// Shift right, preserve bit 7
@@ -559,14 +687,14 @@ static inline void opcodes_sra(Cpu* cpu, uint8_t* reg){
 
 	// Set Z flag if result is 0
 	if (*reg == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear N and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 }
 
 #endif /*CPU_INLINE_H*/
@@ -0,0 +1,526 @@
+#ifndef CPU_OPCODE_TABLE_H
+#define CPU_OPCODE_TABLE_H
+
+// Opcode specification, the single source for the Instruction tables (cpu.c) and
+// the fused switch core (cpu_dispatch.h).
+// X(opcode, handler, disassembly, operand length, M-cycles, kind) where kind is
+//   PLAIN   fixed length and cycle count
+//   JUMP    unconditional jump/call/return/restart, the handler always sets PC
+//   BRANCH  conditional, the handler sets cycles_left for the taken/not taken case
+// Opcodes that are not listed are not implemented.
+
+#define BASE_OPCODES(X) \
+	X(0x00, opCode0x00, "NOP", 0, 1, PLAIN) \
+	X(0x01, opCode0x01, "LD BC, $%x", 2, 3, PLAIN) \
+	X(0x02, opCode0x02, "LD (BC), A", 0, 2, PLAIN) \
+	X(0x03, opCode0x03, "INC BC", 0, 2, PLAIN) \
+	X(0x04, opCode0x04, "INC B", 0, 1, PLAIN) \
+	X(0x05, opCode0x05, "DEC B", 0, 1, PLAIN) \
+	X(0x06, opCode0x06, "LD B, 0x%x", 1, 2, PLAIN) \
+	X(0x07, opCode0x07, "RLCA", 0, 1, PLAIN) \
+	X(0x08, opCode0x08, "LD $%x, SP", 2, 5, PLAIN) \
+	X(0x09, opCode0x09, "ADD HL, BC", 0, 2, PLAIN) \
+	X(0x0a, opCode0x0a, "LD A,(BC)", 0, 2, PLAIN) \
+	X(0x0b, opCode0x0b, "DEC BC", 0, 2, PLAIN) \
+	X(0x0c, opCode0x0c, "INC C", 0, 1, PLAIN) \
+	X(0x0d, opCode0x0d, "DEC C", 0, 1, PLAIN) \
+	X(0x0e, opCode0x0e, "LD C, 0x%x", 1, 2, PLAIN) \
+	X(0x0f, opCode0x0f, "RRCA", 0, 1, PLAIN) \
+	X(0x10, opCode0x10, "STOP", 0, 1, PLAIN) \
+	X(0x11, opCode0x11, "LD DE, $%x", 2, 3, PLAIN) \
+	X(0x12, opCode0x12, "LD (DE), A", 0, 2, PLAIN) \
+	X(0x13, opCode0x13, "INC DE", 0, 2, PLAIN) \
+	X(0x14, opCode0x14, "INC D", 0, 1, PLAIN) \
+	X(0x15, opCode0x15, "DEC D", 0, 1, PLAIN) \
+	X(0x16, opCode0x16, "LD D, 0x%x", 1, 2, PLAIN) \
+	X(0x17, opCode0x17, "RLA", 0, 1, PLAIN) \
+	X(0x18, opCode0x18, "JR 0x%x", 1, 3, JUMP) \
+	X(0x19, opCode0x19, "ADD HL, DE", 0, 2, PLAIN) \
+	X(0x1a, opCode0x1a, "LD A, (DE)", 0, 2, PLAIN) \
+	X(0x1b, opCode0x1b, "DEC DE", 0, 2, PLAIN) \
+	X(0x1c, opCode0x1c, "INC E", 0, 1, PLAIN) \
+	X(0x1d, opCode0x1d, "DEC E", 0, 1, PLAIN) \
+	X(0x1e, opCode0x1e, "LD E, 0x%x", 1, 2, PLAIN) \
+	X(0x1f, opCode0x1f, "RRA", 0, 1, PLAIN) \
+	X(0x20, opCode0x20, "JRNZ, 0x%x", 1, 2, BRANCH) \
+	X(0x21, opCode0x21, "LD HL, $%x", 2, 3, PLAIN) \
+	X(0x22, opCode0x22, "LDI HL, A", 0, 2, PLAIN) \
+	X(0x23, opCode0x23, "INC HL", 0, 2, PLAIN) \
+	X(0x24, opCode0x24, "INC H", 0, 1, PLAIN) \
+	X(0x25, opCode0x25, "DEC H", 0, 1, PLAIN) \
+	X(0x26, opCode0x26, "LD H, 0x%x", 1, 2, PLAIN) \
+	X(0x27, opCode0x27, "DAA", 0, 1, PLAIN) \
+	X(0x28, opCode0x28, "JR Z, 0x%x", 1, 2, BRANCH) \
+	X(0x29, opCode0x29, "ADD HL, HL", 0, 2, PLAIN) \
+	X(0x2a, opCode0x2a, "LDI A, (HL)", 0, 2, PLAIN) \
+	X(0x2b, opCode0x2b, "DEC HL", 0, 2, PLAIN) \
+	X(0x2c, opCode0x2c, "INC L", 0, 1, PLAIN) \
+	X(0x2d, opCode0x2d, "DEC L", 0, 1, PLAIN) \
+	X(0x2e, opCode0x2e, "LD L, 0x%x", 1, 2, PLAIN) \
+	X(0x2f, opCode0x2f, "CPL", 0, 1, PLAIN) \
+	X(0x30, opCode0x30, "JR NC, 0x%x", 1, 2, BRANCH) \
+	X(0x31, opCode0x31, "LD SP, $%x", 2, 3, PLAIN) \
+	X(0x32, opCode0x32, "LDD HL, A", 0, 2, PLAIN) \
+	X(0x33, opCode0x33, "INC SP", 0, 2, PLAIN) \
+	X(0x34, opCode0x34, "INC (HL)", 0, 3, PLAIN) \
+	X(0x35, opCode0x35, "DEC (HL)", 0, 3, PLAIN) \
+	X(0x36, opCode0x36, "LD (HL), 0x%x", 1, 3, PLAIN) \
+	X(0x37, opCode0x37, "SCF", 0, 1, PLAIN) \
+	X(0x38, opCode0x38, "JR C, 0x%x", 1, 2, BRANCH) \
+	X(0x39, opCode0x39, "ADD HL, SP", 0, 2, PLAIN) \
+	X(0x3a, opCode0x3a, "LDD A,(HL)", 0, 2, PLAIN) \
+	X(0x3b, opCode0x3b, "DEC SP", 0, 2, PLAIN) \
+	X(0x3c, opCode0x3c, "INC A", 0, 1, PLAIN) \
+	X(0x3d, opCode0x3d, "DEC A", 0, 1, PLAIN) \
+	X(0x3e, opCode0x3e, "LD A, $%x", 1, 2, PLAIN) \
+	X(0x3f, opCode0x3f, "CCF", 0, 1, PLAIN) \
+	X(0x40, opCode0x40, "LD B,B", 0, 1, PLAIN) \
+	X(0x41, opCode0x41, "LD B,C", 0, 1, PLAIN) \
+	X(0x42, opCode0x42, "LD B,D", 0, 1, PLAIN) \
+	X(0x43, opCode0x43, "LD B,E", 0, 1, PLAIN) \
+	X(0x44, opCode0x44, "LD B,H", 0, 1, PLAIN) \
+	X(0x45, opCode0x45, "LD B,L", 0, 1, PLAIN) \
+	X(0x46, opCode0x46, "LD B,(HL)", 0, 2, PLAIN) \
+	X(0x47, opCode0x47, "LD B,A", 0, 1, PLAIN) \
+	X(0x48, opCode0x48, "LD C,B", 0, 1, PLAIN) \
+	X(0x49, opCode0x49, "LD C,C", 0, 1, PLAIN) \
+	X(0x4a, opCode0x4a, "LD C,D", 0, 1, PLAIN) \
+	X(0x4b, opCode0x4b, "LD C,E", 0, 1, PLAIN) \
+	X(0x4c, opCode0x4c, "LD C,H", 0, 1, PLAIN) \
+	X(0x4d, opCode0x4d, "LD C,L", 0, 1, PLAIN) \
+	X(0x4e, opCode0x4e, "LD C,(HL)", 0, 2, PLAIN) \
+	X(0x4f, opCode0x4f, "LD C,A", 0, 1, PLAIN) \
+	X(0x50, opCode0x50, "LD D,B", 0, 1, PLAIN) \
+	X(0x51, opCode0x51, "LD D,C", 0, 1, PLAIN) \
+	X(0x52, opCode0x52, "LD D,D", 0, 1, PLAIN) \
+	X(0x53, opCode0x53, "LD D,E", 0, 1, PLAIN) \
+	X(0x54, opCode0x54, "LD D,H", 0, 1, PLAIN) \
+	X(0x55, opCode0x55, "LD D,L", 0, 1, PLAIN) \
+	X(0x56, opCode0x56, "LD D,(HL)", 0, 2, PLAIN) \
+	X(0x57, opCode0x57, "LD D,A", 0, 1, PLAIN) \
+	X(0x58, opCode0x58, "LD E,B", 0, 1, PLAIN) \
+	X(0x59, opCode0x59, "LD E,C", 0, 1, PLAIN) \
+	X(0x5a, opCode0x5a, "LD E,D", 0, 1, PLAIN) \
+	X(0x5b, opCode0x5b, "LD E,E", 0, 1, PLAIN) \
+	X(0x5c, opCode0x5c, "LD E,H", 0, 1, PLAIN) \
+	X(0x5d, opCode0x5d, "LD E,L", 0, 1, PLAIN) \
+	X(0x5e, opCode0x5e, "LD E,(HL)", 0, 2, PLAIN) \
+	X(0x5f, opCode0x5f, "LD E,A", 0, 1, PLAIN) \
+	X(0x60, opCode0x60, "LD H,B", 0, 1, PLAIN) \
+	X(0x61, opCode0x61, "LD H,C", 0, 1, PLAIN) \
+	X(0x62, opCode0x62, "LD H,D", 0, 1, PLAIN) \
+	X(0x63, opCode0x63, "LD H,E", 0, 1, PLAIN) \
+	X(0x64, opCode0x64, "LD H,H", 0, 1, PLAIN) \
+	X(0x65, opCode0x65, "LD H,L", 0, 1, PLAIN) \
+	X(0x66, opCode0x66, "LD H,(HL)", 0, 2, PLAIN) \
+	X(0x67, opCode0x67, "LD H,A", 0, 1, PLAIN) \
+	X(0x68, opCode0x68, "LD L,B", 0, 1, PLAIN) \
+	X(0x69, opCode0x69, "LD L,C", 0, 1, PLAIN) \
+	X(0x6a, opCode0x6a, "LD L,D", 0, 1, PLAIN) \
+	X(0x6b, opCode0x6b, "LD L,E", 0, 1, PLAIN) \
+	X(0x6c, opCode0x6c, "LD L,H", 0, 1, PLAIN) \
+	X(0x6d, opCode0x6d, "LD L,L", 0, 1, PLAIN) \
+	X(0x6e, opCode0x6e, "LD L,(HL)", 0, 2, PLAIN) \
+	X(0x6f, opCode0x6f, "LD L,A", 0, 1, PLAIN) \
+	X(0x70, opCode0x70, "LD (HL),B", 0, 2, PLAIN) \
+	X(0x71, opCode0x71, "LD (HL),C", 0, 2, PLAIN) \
+	X(0x72, opCode0x72, "LD (HL),D", 0, 2, PLAIN) \
+	X(0x73, opCode0x73, "LD (HL),E", 0, 2, PLAIN) \
+	X(0x74, opCode0x74, "LD (HL),H", 0, 2, PLAIN) \
+	X(0x75, opCode0x75, "LD (HL),L", 0, 2, PLAIN) \
+	X(0x76, opCode0x76, "HALT", 0, 1, PLAIN) \
+	X(0x77, opCode0x77, "LD (HL), A", 0, 2, PLAIN) \
+	X(0x78, opCode0x78, "LD A,B", 0, 1, PLAIN) \
+	X(0x79, opCode0x79, "LD A,C", 0, 1, PLAIN) \
+	X(0x7a, opCode0x7a, "LD A,D", 0, 1, PLAIN) \
+	X(0x7b, opCode0x7b, "LD A,E", 0, 1, PLAIN) \
+	X(0x7c, opCode0x7c, "LD A,H", 0, 1, PLAIN) \
+	X(0x7d, opCode0x7d, "LD A,L", 0, 1, PLAIN) \
+	X(0x7e, opCode0x7e, "LD A,(HL)", 0, 2, PLAIN) \
+	X(0x7f, opCode0x7f, "LD A,A", 0, 1, PLAIN) \
+	X(0x80, opCode0x80, "ADD A,B", 0, 1, PLAIN) \
+	X(0x81, opCode0x81, "ADD A,C", 0, 1, PLAIN) \
+	X(0x82, opCode0x82, "ADD A,D", 0, 1, PLAIN) \
+	X(0x83, opCode0x83, "ADD A,E", 0, 1, PLAIN) \
+	X(0x84, opCode0x84, "ADD A,H", 0, 1, PLAIN) \
+	X(0x85, opCode0x85, "ADD A,L", 0, 1, PLAIN) \
+	X(0x86, opCode0x86, "ADD A,(HL)", 0, 2, PLAIN) \
+	X(0x87, opCode0x87, "ADD A,A", 0, 1, PLAIN) \
+	X(0x88, opCode0x88, "ADC A,B", 0, 1, PLAIN) \
+	X(0x89, opCode0x89, "ADC A,C", 0, 1, PLAIN) \
+	X(0x8a, opCode0x8a, "ADC A,D", 0, 1, PLAIN) \
+	X(0x8b, opCode0x8b, "ADC A,E", 0, 1, PLAIN) \
+	X(0x8c, opCode0x8c, "ADC A,H", 0, 1, PLAIN) \
+	X(0x8d, opCode0x8d, "ADC A,L", 0, 1, PLAIN) \
+	X(0x8e, opCode0x8e, "ADC A,(HL)", 0, 2, PLAIN) \
+	X(0x8f, opCode0x8f, "ADC A,A", 0, 1, PLAIN) \
+	X(0x90, opCode0x90, "SUB B", 0, 1, PLAIN) \
+	X(0x91, opCode0x91, "SUB C", 0, 1, PLAIN) \
+	X(0x92, opCode0x92, "SUB D", 0, 1, PLAIN) \
+	X(0x93, opCode0x93, "SUB E", 0, 1, PLAIN) \
+	X(0x94, opCode0x94, "SUB H", 0, 1, PLAIN) \
+	X(0x95, opCode0x95, "SUB L", 0, 1, PLAIN) \
+	X(0x96, opCode0x96, "SUB (HL)", 0, 2, PLAIN) \
+	X(0x97, opCode0x97, "SUB A", 0, 1, PLAIN) \
+	X(0x98, opCode0x98, "SBC A,B", 0, 1, PLAIN) \
+	X(0x99, opCode0x99, "SBC A,C", 0, 1, PLAIN) \
+	X(0x9a, opCode0x9a, "SBC A,D", 0, 1, PLAIN) \
+	X(0x9b, opCode0x9b, "SBC A,E", 0, 1, PLAIN) \
+	X(0x9c, opCode0x9c, "SBC A,H", 0, 1, PLAIN) \
+	X(0x9d, opCode0x9d, "SBC A,L", 0, 1, PLAIN) \
+	X(0x9e, opCode0x9e, "SBC A,(HL)", 0, 2, PLAIN) \
+	X(0x9f, opCode0x9f, "SBC A,A", 0, 1, PLAIN) \
+	X(0xa0, opCode0xa0, "AND B", 0, 1, PLAIN) \
+	X(0xa1, opCode0xa1, "AND C", 0, 1, PLAIN) \
+	X(0xa2, opCode0xa2, "AND D", 0, 1, PLAIN) \
+	X(0xa3, opCode0xa3, "AND E", 0, 1, PLAIN) \
+	X(0xa4, opCode0xa4, "AND H", 0, 1, PLAIN) \
+	X(0xa5, opCode0xa5, "AND L", 0, 1, PLAIN) \
+	X(0xa6, opCode0xa6, "AND (HL)", 0, 2, PLAIN) \
+	X(0xa7, opCode0xa7, "AND A", 0, 1, PLAIN) \
+	X(0xa8, opCode0xa8, "XOR B", 0, 1, PLAIN) \
+	X(0xa9, opCode0xa9, "XOR C", 0, 1, PLAIN) \
+	X(0xaa, opCode0xaa, "XOR D", 0, 1, PLAIN) \
+	X(0xab, opCode0xab, "XOR E", 0, 1, PLAIN) \
+	X(0xac, opCode0xac, "XOR H", 0, 1, PLAIN) \
+	X(0xad, opCode0xad, "XOR L", 0, 1, PLAIN) \
+	X(0xae, opCode0xae, "XOR (HL)", 0, 2, PLAIN) \
+	X(0xaf, opCode0xaf, "XOR A, A", 0, 1, PLAIN) \
+	X(0xb0, opCode0xb0, "OR B", 0, 1, PLAIN) \
+	X(0xb1, opCode0xb1, "OR C", 0, 1, PLAIN) \
+	X(0xb2, opCode0xb2, "OR D", 0, 1, PLAIN) \
+	X(0xb3, opCode0xb3, "OR E", 0, 1, PLAIN) \
+	X(0xb4, opCode0xb4, "OR H", 0, 1, PLAIN) \
+	X(0xb5, opCode0xb5, "OR L", 0, 1, PLAIN) \
+	X(0xb6, opCode0xb6, "OR (HL)", 0, 2, PLAIN) \
+	X(0xb7, opCode0xb7, "OR A", 0, 1, PLAIN) \
+	X(0xb8, opCode0xb8, "CP B", 0, 1, PLAIN) \
+	X(0xb9, opCode0xb9, "CP C", 0, 1, PLAIN) \
+	X(0xba, opCode0xba, "CP D", 0, 1, PLAIN) \
+	X(0xbb, opCode0xbb, "CP E", 0, 1, PLAIN) \
+	X(0xbc, opCode0xbc, "CP H", 0, 1, PLAIN) \
+	X(0xbd, opCode0xbd, "CP L", 0, 1, PLAIN) \
+	X(0xbe, opCode0xbe, "CP (HL)", 0, 2, PLAIN) \
+	X(0xbf, opCode0xbf, "CP A", 0, 1, PLAIN) \
+	X(0xc0, opCode0xc0, "RET NZ", 0, 2, BRANCH) \
+	X(0xc1, opCode0xc1, "POP BC", 0, 3, PLAIN) \
+	X(0xc2, opCode0xc2, "JP NZ, $%x", 2, 3, BRANCH) \
+	X(0xc3, opCode0xc3, "JP $%x", 2, 4, JUMP) \
+	X(0xc4, opCode0xc4, "CALL NZ, $%x", 2, 3, BRANCH) \
+	X(0xc5, opCode0xc5, "PUSH BC", 0, 4, PLAIN) \
+	X(0xc6, opCode0xc6, "ADD A,0x%x", 1, 2, PLAIN) \
+	X(0xc7, opCode0xc7, "RST 00", 0, 4, JUMP) \
+	X(0xc8, opCode0xc8, "RET Z", 0, 2, BRANCH) \
+	X(0xc9, opCode0xc9, "RET", 0, 4, JUMP) \
+	X(0xca, opCode0xca, "JP Z, $%x", 2, 3, BRANCH) \
+	X(0xcc, opCode0xcc, "CALL Z, $%x", 2, 3, BRANCH) \
+	X(0xcd, opCode0xcd, "CALL $%x", 2, 6, JUMP) \
+	X(0xce, opCode0xce, "ADC A,0x%x", 1, 2, PLAIN) \
+	X(0xcf, opCode0xcf, "RST 08", 0, 4, JUMP) \
+	X(0xd0, opCode0xd0, "RET NC", 0, 2, BRANCH) \
+	X(0xd1, opCode0xd1, "POP DE", 0, 3, PLAIN) \
+	X(0xd2, opCode0xd2, "JP NC, $%x", 2, 3, BRANCH) \
+	X(0xd4, opCode0xd4, "CALL NC, $%x", 2, 3, BRANCH) \
+	X(0xd5, opCode0xd5, "PUSH DE", 0, 4, PLAIN) \
+	X(0xd6, opCode0xd6, "SUB 0x%x", 1, 2, PLAIN) \
+	X(0xd7, opCode0xd7, "RST 10", 0, 4, JUMP) \
+	X(0xd8, opCode0xd8, "RET C", 0, 2, BRANCH) \
+	X(0xd9, opCode0xd9, "RETI", 0, 4, JUMP) \
+	X(0xda, opCode0xda, "JP C, $%x", 2, 3, BRANCH) \
+	X(0xdc, opCode0xdc, "CALL C, $%x", 2, 3, BRANCH) \
+	X(0xde, opCode0xde, "SBC A,0x%x", 1, 2, PLAIN) \
+	X(0xdf, opCode0xdf, "RST 18", 0, 4, JUMP) \
+	X(0xe0, opCode0xe0, "LDH 0x%x, A", 1, 3, PLAIN) \
+	X(0xe1, opCode0xe1, "POP HL", 0, 3, PLAIN) \
+	X(0xe2, opCode0xe2, "LD (C),A", 0, 2, PLAIN) \
+	X(0xe5, opCode0xe5, "PUSH HL", 0, 4, PLAIN) \
+	X(0xe6, opCode0xe6, "AND 0x%x", 1, 2, PLAIN) \
+	X(0xe7, opCode0xe7, "RST 20", 0, 4, JUMP) \
+	X(0xe8, opCode0xe8, "ADD SP,0x%x", 1, 4, PLAIN) \
+	X(0xe9, opCode0xe9, "JP (HL)", 0, 1, JUMP) \
+	X(0xea, opCode0xea, "LD $%x, A", 2, 4, PLAIN) \
+	X(0xee, opCode0xee, "XOR 0x%x", 1, 2, PLAIN) \
+	X(0xef, opCode0xef, "RST 28", 0, 4, JUMP) \
+	X(0xf0, opCode0xf0, "LDH A, 0x%x", 1, 3, PLAIN) \
+	X(0xf1, opCode0xf1, "POP AF", 0, 3, PLAIN) \
+	X(0xf3, opCode0xf3, "DI", 0, 1, PLAIN) \
+	X(0xf5, opCode0xf5, "PUSH AF", 0, 4, PLAIN) \
+	X(0xf6, opCode0xf6, "OR 0x%x", 1, 2, PLAIN) \
+	X(0xf7, opCode0xf7, "RST 30", 0, 4, JUMP) \
+	X(0xf8, opCode0xf8, "LD HL,SP+0x%x", 1, 3, PLAIN) \
+	X(0xf9, opCode0xf9, "LD SP,HL", 0, 2, PLAIN) \
+	X(0xfa, opCode0xfa, "LD A, $%x", 2, 4, PLAIN) \
+	X(0xfb, opCode0xfb, "EI", 0, 1, PLAIN) \
+	X(0xfe, opCode0xfe, "CP 0x%x", 1, 2, PLAIN) \
+	X(0xff, opCode0xff, "RST 38", 0, 4, JUMP)
+
+#define CB_OPCODES(X) \
+	/* RLC */ \
+	X(0x00, opCode0xcb00, "RLC B", 0, 2, PLAIN) \
+	X(0x01, opCode0xcb01, "RLC C", 0, 2, PLAIN) \
+	X(0x02, opCode0xcb02, "RLC D", 0, 2, PLAIN) \
+	X(0x03, opCode0xcb03, "RLC E", 0, 2, PLAIN) \
+	X(0x04, opCode0xcb04, "RLC H", 0, 2, PLAIN) \
+	X(0x05, opCode0xcb05, "RLC L", 0, 2, PLAIN) \
+	X(0x06, opCode0xcb06, "RLC (HL)", 0, 4, PLAIN) \
+	X(0x07, opCode0xcb07, "RLC A", 0, 2, PLAIN) \
+	/* RRC */ \
+	X(0x08, opCode0xcb08, "RRC B", 0, 2, PLAIN) \
+	X(0x09, opCode0xcb09, "RRC C", 0, 2, PLAIN) \
+	X(0x0a, opCode0xcb0a, "RRC D", 0, 2, PLAIN) \
+	X(0x0b, opCode0xcb0b, "RRC E", 0, 2, PLAIN) \
+	X(0x0c, opCode0xcb0c, "RRC H", 0, 2, PLAIN) \
+	X(0x0d, opCode0xcb0d, "RRC L", 0, 2, PLAIN) \
+	X(0x0e, opCode0xcb0e, "RRC (HL)", 0, 4, PLAIN) \
+	X(0x0f, opCode0xcb0f, "RRC A", 0, 2, PLAIN) \
+	/* RL */ \
+	X(0x10, opCode0xcb10, "RL B", 0, 2, PLAIN) \
+	X(0x11, opCode0xcb11, "RL C", 0, 2, PLAIN) \
+	X(0x12, opCode0xcb12, "RL D", 0, 2, PLAIN) \
+	X(0x13, opCode0xcb13, "RL E", 0, 2, PLAIN) \
+	X(0x14, opCode0xcb14, "RL H", 0, 2, PLAIN) \
+	X(0x15, opCode0xcb15, "RL L", 0, 2, PLAIN) \
+	X(0x16, opCode0xcb16, "RL (HL)", 0, 4, PLAIN) \
+	X(0x17, opCode0xcb17, "RL A", 0, 2, PLAIN) \
+	/* RR */ \
+	X(0x18, opCode0xcb18, "RR B", 0, 2, PLAIN) \
+	X(0x19, opCode0xcb19, "RR C", 0, 2, PLAIN) \
+	X(0x1a, opCode0xcb1a, "RR D", 0, 2, PLAIN) \
+	X(0x1b, opCode0xcb1b, "RR E", 0, 2, PLAIN) \
+	X(0x1c, opCode0xcb1c, "RR H", 0, 2, PLAIN) \
+	X(0x1d, opCode0xcb1d, "RR L", 0, 2, PLAIN) \
+	X(0x1e, opCode0xcb1e, "RR (HL)", 0, 4, PLAIN) \
+	X(0x1f, opCode0xcb1f, "RR A", 0, 2, PLAIN) \
+	/* SLA */ \
+	X(0x20, opCode0xcb20, "SLA B", 0, 2, PLAIN) \
+	X(0x21, opCode0xcb21, "SLA C", 0, 2, PLAIN) \
+	X(0x22, opCode0xcb22, "SLA D", 0, 2, PLAIN) \
+	X(0x23, opCode0xcb23, "SLA E", 0, 2, PLAIN) \
+	X(0x24, opCode0xcb24, "SLA H", 0, 2, PLAIN) \
+	X(0x25, opCode0xcb25, "SLA L", 0, 2, PLAIN) \
+	X(0x26, opCode0xcb26, "SLA (HL)", 0, 4, PLAIN) \
+	X(0x27, opCode0xcb27, "SLA A", 0, 2, PLAIN) \
+	/* SRA */ \
+	X(0x28, opCode0xcb28, "SRA B", 0, 2, PLAIN) \
+	X(0x29, opCode0xcb29, "SRA C", 0, 2, PLAIN) \
+	X(0x2a, opCode0xcb2a, "SRA D", 0, 2, PLAIN) \
+	X(0x2b, opCode0xcb2b, "SRA E", 0, 2, PLAIN) \
+	X(0x2c, opCode0xcb2c, "SRA H", 0, 2, PLAIN) \
+	X(0x2d, opCode0xcb2d, "SRA L", 0, 2, PLAIN) \
+	X(0x2e, opCode0xcb2e, "SRA (HL)", 0, 4, PLAIN) \
+	X(0x2f, opCode0xcb2f, "SRA A", 0, 2, PLAIN) \
+	/* SWAP */ \
+	X(0x30, opCode0xcb30, "SWAP B", 0, 2, PLAIN) \
+	X(0x31, opCode0xcb31, "SWAP C", 0, 2, PLAIN) \
+	X(0x32, opCode0xcb32, "SWAP D", 0, 2, PLAIN) \
+	X(0x33, opCode0xcb33, "SWAP E", 0, 2, PLAIN) \
+	X(0x34, opCode0xcb34, "SWAP H", 0, 2, PLAIN) \
+	X(0x35, opCode0xcb35, "SWAP L", 0, 2, PLAIN) \
+	X(0x36, opCode0xcb36, "SWAP (HL)", 0, 4, PLAIN) \
+	X(0x37, opCode0xcb37, "SWAP A", 0, 2, PLAIN) \
+	/* SRL */ \
+	X(0x38, opCode0xcb38, "SRL B", 0, 2, PLAIN) \
+	X(0x39, opCode0xcb39, "SRL C", 0, 2, PLAIN) \
+	X(0x3a, opCode0xcb3a, "SRL D", 0, 2, PLAIN) \
+	X(0x3b, opCode0xcb3b, "SRL E", 0, 2, PLAIN) \
+	X(0x3c, opCode0xcb3c, "SRL H", 0, 2, PLAIN) \
+	X(0x3d, opCode0xcb3d, "SRL L", 0, 2, PLAIN) \
+	X(0x3e, opCode0xcb3e, "SRL (HL)", 0, 4, PLAIN) \
+	X(0x3f, opCode0xcb3f, "SRL A", 0, 2, PLAIN) \
+	/* BIT */ \
+	X(0x40, opCode0xcb40, "BIT 0, B", 0, 2, PLAIN) \
+	X(0x41, opCode0xcb41, "BIT 0, C", 0, 2, PLAIN) \
+	X(0x42, opCode0xcb42, "BIT 0, D", 0, 2, PLAIN) \
+	X(0x43, opCode0xcb43, "BIT 0, E", 0, 2, PLAIN) \
+	X(0x44, opCode0xcb44, "BIT 0, H", 0, 2, PLAIN) \
+	X(0x45, opCode0xcb45, "BIT 0, L", 0, 2, PLAIN) \
+	X(0x46, opCode0xcb46, "BIT 0, (HL)", 0, 3, PLAIN) \
+	X(0x47, opCode0xcb47, "BIT 0, A", 0, 2, PLAIN) \
+	X(0x48, opCode0xcb48, "BIT 1, B", 0, 2, PLAIN) \
+	X(0x49, opCode0xcb49, "BIT 1, C", 0, 2, PLAIN) \
+	X(0x4a, opCode0xcb4a, "BIT 1, D", 0, 2, PLAIN) \
+	X(0x4b, opCode0xcb4b, "BIT 1, E", 0, 2, PLAIN) \
+	X(0x4c, opCode0xcb4c, "BIT 1, H", 0, 2, PLAIN) \
+	X(0x4d, opCode0xcb4d, "BIT 1, L", 0, 2, PLAIN) \
+	X(0x4e, opCode0xcb4e, "BIT 1, (HL)", 0, 3, PLAIN) \
+	X(0x4f, opCode0xcb4f, "BIT 1, A", 0, 2, PLAIN) \
+	X(0x50, opCode0xcb50, "BIT 2, B", 0, 2, PLAIN) \
+	X(0x51, opCode0xcb51, "BIT 2, C", 0, 2, PLAIN) \
+	X(0x52, opCode0xcb52, "BIT 2, D", 0, 2, PLAIN) \
+	X(0x53, opCode0xcb53, "BIT 2, E", 0, 2, PLAIN) \
+	X(0x54, opCode0xcb54, "BIT 2, H", 0, 2, PLAIN) \
+	X(0x55, opCode0xcb55, "BIT 2, L", 0, 2, PLAIN) \
+	X(0x56, opCode0xcb56, "BIT 2, (HL)", 0, 3, PLAIN) \
+	X(0x57, opCode0xcb57, "BIT 2, A", 0, 2, PLAIN) \
+	X(0x58, opCode0xcb58, "BIT 3, B", 0, 2, PLAIN) \
+	X(0x59, opCode0xcb59, "BIT 3, C", 0, 2, PLAIN) \
+	X(0x5a, opCode0xcb5a, "BIT 3, D", 0, 2, PLAIN) \
+	X(0x5b, opCode0xcb5b, "BIT 3, E", 0, 2, PLAIN) \
+	X(0x5c, opCode0xcb5c, "BIT 3, H", 0, 2, PLAIN) \
+	X(0x5d, opCode0xcb5d, "BIT 3, L", 0, 2, PLAIN) \
+	X(0x5e, opCode0xcb5e, "BIT 3, (HL)", 0, 3, PLAIN) \
+	X(0x5f, opCode0xcb5f, "BIT 3, A", 0, 2, PLAIN) \
+	X(0x60, opCode0xcb60, "BIT 4, B", 0, 2, PLAIN) \
+	X(0x61, opCode0xcb61, "BIT 4, C", 0, 2, PLAIN) \
+	X(0x62, opCode0xcb62, "BIT 4, D", 0, 2, PLAIN) \
+	X(0x63, opCode0xcb63, "BIT 4, E", 0, 2, PLAIN) \
+	X(0x64, opCode0xcb64, "BIT 4, H", 0, 2, PLAIN) \
+	X(0x65, opCode0xcb65, "BIT 4, L", 0, 2, PLAIN) \
+	X(0x66, opCode0xcb66, "BIT 4, (HL)", 0, 3, PLAIN) \
+	X(0x67, opCode0xcb67, "BIT 4, A", 0, 2, PLAIN) \
+	X(0x68, opCode0xcb68, "BIT 5, B", 0, 2, PLAIN) \
+	X(0x69, opCode0xcb69, "BIT 5, C", 0, 2, PLAIN) \
+	X(0x6a, opCode0xcb6a, "BIT 5, D", 0, 2, PLAIN) \
+	X(0x6b, opCode0xcb6b, "BIT 5, E", 0, 2, PLAIN) \
+	X(0x6c, opCode0xcb6c, "BIT 5, H", 0, 2, PLAIN) \
+	X(0x6d, opCode0xcb6d, "BIT 5, L", 0, 2, PLAIN) \
+	X(0x6e, opCode0xcb6e, "BIT 5, (HL)", 0, 3, PLAIN) \
+	X(0x6f, opCode0xcb6f, "BIT 5, A", 0, 2, PLAIN) \
+	X(0x70, opCode0xcb70, "BIT 6, B", 0, 2, PLAIN) \
+	X(0x71, opCode0xcb71, "BIT 6, C", 0, 2, PLAIN) \
+	X(0x72, opCode0xcb72, "BIT 6, D", 0, 2, PLAIN) \
+	X(0x73, opCode0xcb73, "BIT 6, E", 0, 2, PLAIN) \
+	X(0x74, opCode0xcb74, "BIT 6, H", 0, 2, PLAIN) \
+	X(0x75, opCode0xcb75, "BIT 6, L", 0, 2, PLAIN) \
+	X(0x76, opCode0xcb76, "BIT 6, (HL)", 0, 3, PLAIN) \
+	X(0x77, opCode0xcb77, "BIT 6, A", 0, 2, PLAIN) \
+	X(0x78, opCode0xcb78, "BIT 7, B", 0, 2, PLAIN) \
+	X(0x79, opCode0xcb79, "BIT 7, C", 0, 2, PLAIN) \
+	X(0x7a, opCode0xcb7a, "BIT 7, D", 0, 2, PLAIN) \
+	X(0x7b, opCode0xcb7b, "BIT 7, E", 0, 2, PLAIN) \
+	X(0x7c, opCode0xcb7c, "BIT 7, H", 0, 2, PLAIN) \
+	X(0x7d, opCode0xcb7d, "BIT 7, L", 0, 2, PLAIN) \
+	X(0x7e, opCode0xcb7e, "BIT 7, (HL)", 0, 3, PLAIN) \
+	X(0x7f, opCode0xcb7f, "BIT 7, A", 0, 2, PLAIN) \
+	/* RES */ \
+	X(0x80, opCode0xcb80, "RES 0, B", 0, 2, PLAIN) \
+	X(0x81, opCode0xcb81, "RES 0, C", 0, 2, PLAIN) \
+	X(0x82, opCode0xcb82, "RES 0, D", 0, 2, PLAIN) \
+	X(0x83, opCode0xcb83, "RES 0, E", 0, 2, PLAIN) \
+	X(0x84, opCode0xcb84, "RES 0, H", 0, 2, PLAIN) \
+	X(0x85, opCode0xcb85, "RES 0, L", 0, 2, PLAIN) \
+	X(0x86, opCode0xcb86, "RES 0, (HL)", 0, 4, PLAIN) \
+	X(0x87, opCode0xcb87, "RES 0, A", 0, 2, PLAIN) \
+	X(0x88, opCode0xcb88, "RES 1, B", 0, 2, PLAIN) \
+	X(0x89, opCode0xcb89, "RES 1, C", 0, 2, PLAIN) \
+	X(0x8a, opCode0xcb8a, "RES 1, D", 0, 2, PLAIN) \
+	X(0x8b, opCode0xcb8b, "RES 1, E", 0, 2, PLAIN) \
+	X(0x8c, opCode0xcb8c, "RES 1, H", 0, 2, PLAIN) \
+	X(0x8d, opCode0xcb8d, "RES 1, L", 0, 2, PLAIN) \
+	X(0x8e, opCode0xcb8e, "RES 1, (HL)", 0, 4, PLAIN) \
+	X(0x8f, opCode0xcb8f, "RES 1, A", 0, 2, PLAIN) \
+	X(0x90, opCode0xcb90, "RES 2, B", 0, 2, PLAIN) \
+	X(0x91, opCode0xcb91, "RES 2, C", 0, 2, PLAIN) \
+	X(0x92, opCode0xcb92, "RES 2, D", 0, 2, PLAIN) \
+	X(0x93, opCode0xcb93, "RES 2, E", 0, 2, PLAIN) \
+	X(0x94, opCode0xcb94, "RES 2, H", 0, 2, PLAIN) \
+	X(0x95, opCode0xcb95, "RES 2, L", 0, 2, PLAIN) \
+	X(0x96, opCode0xcb96, "RES 2, (HL)", 0, 4, PLAIN) \
+	X(0x97, opCode0xcb97, "RES 2, A", 0, 2, PLAIN) \
+	X(0x98, opCode0xcb98, "RES 3, B", 0, 2, PLAIN) \
+	X(0x99, opCode0xcb99, "RES 3, C", 0, 2, PLAIN) \
+	X(0x9a, opCode0xcb9a, "RES 3, D", 0, 2, PLAIN) \
+	X(0x9b, opCode0xcb9b, "RES 3, E", 0, 2, PLAIN) \
+	X(0x9c, opCode0xcb9c, "RES 3, H", 0, 2, PLAIN) \
+	X(0x9d, opCode0xcb9d, "RES 3, L", 0, 2, PLAIN) \
+	X(0x9e, opCode0xcb9e, "RES 3, (HL)", 0, 4, PLAIN) \
+	X(0x9f, opCode0xcb9f, "RES 3, A", 0, 2, PLAIN) \
+	X(0xa0, opCode0xcba0, "RES 4, B", 0, 2, PLAIN) \
+	X(0xa1, opCode0xcba1, "RES 4, C", 0, 2, PLAIN) \
+	X(0xa2, opCode0xcba2, "RES 4, D", 0, 2, PLAIN) \
+	X(0xa3, opCode0xcba3, "RES 4, E", 0, 2, PLAIN) \
+	X(0xa4, opCode0xcba4, "RES 4, H", 0, 2, PLAIN) \
+	X(0xa5, opCode0xcba5, "RES 4, L", 0, 2, PLAIN) \
+	X(0xa6, opCode0xcba6, "RES 4, (HL)", 0, 4, PLAIN) \
+	X(0xa7, opCode0xcba7, "RES 4, A", 0, 2, PLAIN) \
+	X(0xa8, opCode0xcba8, "RES 5, B", 0, 2, PLAIN) \
+	X(0xa9, opCode0xcba9, "RES 5, C", 0, 2, PLAIN) \
+	X(0xaa, opCode0xcbaa, "RES 5, D", 0, 2, PLAIN) \
+	X(0xab, opCode0xcbab, "RES 5, E", 0, 2, PLAIN) \
+	X(0xac, opCode0xcbac, "RES 5, H", 0, 2, PLAIN) \
+	X(0xad, opCode0xcbad, "RES 5, L", 0, 2, PLAIN) \
+	X(0xae, opCode0xcbae, "RES 5, (HL)", 0, 4, PLAIN) \
+	X(0xaf, opCode0xcbaf, "RES 5, A", 0, 2, PLAIN) \
+	X(0xb0, opCode0xcbb0, "RES 6, B", 0, 2, PLAIN) \
+	X(0xb1, opCode0xcbb1, "RES 6, C", 0, 2, PLAIN) \
+	X(0xb2, opCode0xcbb2, "RES 6, D", 0, 2, PLAIN) \
+	X(0xb3, opCode0xcbb3, "RES 6, E", 0, 2, PLAIN) \
+	X(0xb4, opCode0xcbb4, "RES 6, H", 0, 2, PLAIN) \
+	X(0xb5, opCode0xcbb5, "RES 6, L", 0, 2, PLAIN) \
+	X(0xb6, opCode0xcbb6, "RES 6, (HL)", 0, 4, PLAIN) \
+	X(0xb7, opCode0xcbb7, "RES 6, A", 0, 2, PLAIN) \
+	X(0xb8, opCode0xcbb8, "RES 7, B", 0, 2, PLAIN) \
+	X(0xb9, opCode0xcbb9, "RES 7, C", 0, 2, PLAIN) \
+	X(0xba, opCode0xcbba, "RES 7, D", 0, 2, PLAIN) \
+	X(0xbb, opCode0xcbbb, "RES 7, E", 0, 2, PLAIN) \
+	X(0xbc, opCode0xcbbc, "RES 7, H", 0, 2, PLAIN) \
+	X(0xbd, opCode0xcbbd, "RES 7, L", 0, 2, PLAIN) \
+	X(0xbe, opCode0xcbbe, "RES 7, (HL)", 0, 4, PLAIN) \
+	X(0xbf, opCode0xcbbf, "RES 7, A", 0, 2, PLAIN) \
+	/* SET */ \
+	X(0xc0, opCode0xcbc0, "SET 0, B", 0, 2, PLAIN) \
+	X(0xc1, opCode0xcbc1, "SET 0, C", 0, 2, PLAIN) \
+	X(0xc2, opCode0xcbc2, "SET 0, D", 0, 2, PLAIN) \
+	X(0xc3, opCode0xcbc3, "SET 0, E", 0, 2, PLAIN) \
+	X(0xc4, opCode0xcbc4, "SET 0, H", 0, 2, PLAIN) \
+	X(0xc5, opCode0xcbc5, "SET 0, L", 0, 2, PLAIN) \
+	X(0xc6, opCode0xcbc6, "SET 0, (HL)", 0, 4, PLAIN) \
+	X(0xc7, opCode0xcbc7, "SET 0, A", 0, 2, PLAIN) \
+	X(0xc8, opCode0xcbc8, "SET 1, B", 0, 2, PLAIN) \
+	X(0xc9, opCode0xcbc9, "SET 1, C", 0, 2, PLAIN) \
+	X(0xca, opCode0xcbca, "SET 1, D", 0, 2, PLAIN) \
+	X(0xcb, opCode0xcbcb, "SET 1, E", 0, 2, PLAIN) \
+	X(0xcc, opCode0xcbcc, "SET 1, H", 0, 2, PLAIN) \
+	X(0xcd, opCode0xcbcd, "SET 1, L", 0, 2, PLAIN) \
+	X(0xce, opCode0xcbce, "SET 1, (HL)", 0, 4, PLAIN) \
+	X(0xcf, opCode0xcbcf, "SET 1, A", 0, 2, PLAIN) \
+	X(0xd0, opCode0xcbd0, "SET 2, B", 0, 2, PLAIN) \
+	X(0xd1, opCode0xcbd1, "SET 2, C", 0, 2, PLAIN) \
+	X(0xd2, opCode0xcbd2, "SET 2, D", 0, 2, PLAIN) \
+	X(0xd3, opCode0xcbd3, "SET 2, E", 0, 2, PLAIN) \
+	X(0xd4, opCode0xcbd4, "SET 2, H", 0, 2, PLAIN) \
+	X(0xd5, opCode0xcbd5, "SET 2, L", 0, 2, PLAIN) \
+	X(0xd6, opCode0xcbd6, "SET 2, (HL)", 0, 4, PLAIN) \
+	X(0xd7, opCode0xcbd7, "SET 2, A", 0, 2, PLAIN) \
+	X(0xd8, opCode0xcbd8, "SET 3, B", 0, 2, PLAIN) \
+	X(0xd9, opCode0xcbd9, "SET 3, C", 0, 2, PLAIN) \
+	X(0xda, opCode0xcbda, "SET 3, D", 0, 2, PLAIN) \
+	X(0xdb, opCode0xcbdb, "SET 3, E", 0, 2, PLAIN) \
+	X(0xdc, opCode0xcbdc, "SET 3, H", 0, 2, PLAIN) \
+	X(0xdd, opCode0xcbdd, "SET 3, L", 0, 2, PLAIN) \
+	X(0xde, opCode0xcbde, "SET 3, (HL)", 0, 4, PLAIN) \
+	X(0xdf, opCode0xcbdf, "SET 3, A", 0, 2, PLAIN) \
+	X(0xe0, opCode0xcbe0, "SET 4, B", 0, 2, PLAIN) \
+	X(0xe1, opCode0xcbe1, "SET 4, C", 0, 2, PLAIN) \
+	X(0xe2, opCode0xcbe2, "SET 4, D", 0, 2, PLAIN) \
+	X(0xe3, opCode0xcbe3, "SET 4, E", 0, 2, PLAIN) \
+	X(0xe4, opCode0xcbe4, "SET 4, H", 0, 2, PLAIN) \
+	X(0xe5, opCode0xcbe5, "SET 4, L", 0, 2, PLAIN) \
+	X(0xe6, opCode0xcbe6, "SET 4, (HL)", 0, 4, PLAIN) \
+	X(0xe7, opCode0xcbe7, "SET 4, A", 0, 2, PLAIN) \
+	X(0xe8, opCode0xcbe8, "SET 5, B", 0, 2, PLAIN) \
+	X(0xe9, opCode0xcbe9, "SET 5, C", 0, 2, PLAIN) \
+	X(0xea, opCode0xcbea, "SET 5, D", 0, 2, PLAIN) \
+	X(0xeb, opCode0xcbeb, "SET 5, E", 0, 2, PLAIN) \
+	X(0xec, opCode0xcbec, "SET 5, H", 0, 2, PLAIN) \
+	X(0xed, opCode0xcbed, "SET 5, L", 0, 2, PLAIN) \
+	X(0xee, opCode0xcbee, "SET 5, (HL)", 0, 4, PLAIN) \
+	X(0xef, opCode0xcbef, "SET 5, A", 0, 2, PLAIN) \
+	X(0xf0, opCode0xcbf0, "SET 6, B", 0, 2, PLAIN) \
+	X(0xf1, opCode0xcbf1, "SET 6, C", 0, 2, PLAIN) \
+	X(0xf2, opCode0xcbf2, "SET 6, D", 0, 2, PLAIN) \
+	X(0xf3, opCode0xcbf3, "SET 6, E", 0, 2, PLAIN) \
+	X(0xf4, opCode0xcbf4, "SET 6, H", 0, 2, PLAIN) \
+	X(0xf5, opCode0xcbf5, "SET 6, L", 0, 2, PLAIN) \
+	X(0xf6, opCode0xcbf6, "SET 6, (HL)", 0, 4, PLAIN) \
+	X(0xf7, opCode0xcbf7, "SET 6, A", 0, 2, PLAIN) \
+	X(0xf8, opCode0xcbf8, "SET 7, B", 0, 2, PLAIN) \
+	X(0xf9, opCode0xcbf9, "SET 7, C", 0, 2, PLAIN) \
+	X(0xfa, opCode0xcbfa, "SET 7, D", 0, 2, PLAIN) \
+	X(0xfb, opCode0xcbfb, "SET 7, E", 0, 2, PLAIN) \
+	X(0xfc, opCode0xcbfc, "SET 7, H", 0, 2, PLAIN) \
+	X(0xfd, opCode0xcbfd, "SET 7, L", 0, 2, PLAIN) \
+	X(0xfe, opCode0xcbfe, "SET 7, (HL)", 0, 4, PLAIN) \
+	X(0xff, opCode0xcbff, "SET 7, A", 0, 2, PLAIN)
+
+#endif /* CPU_OPCODE_TABLE_H */
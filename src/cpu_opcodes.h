@@ -41,15 +41,15 @@ int8_t opCode0x07(Cpu* cpu){ // RLCA
 	cpu->reg_a = (cpu->reg_a << 1) | bit7;
 
 	if (bit7) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// RLCA always clears Z, N, and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
@@ -105,15 +105,15 @@ int8_t opCode0x0f(Cpu* cpu){ // RRCA
 	cpu->reg_a = (cpu->reg_a >> 1) | (bit0 << 7);
 
 	if (bit0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	// RRCA always clears Z, N, and H flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
@@ -200,7 +200,7 @@ int8_t opCode0x18(Cpu* cpu){ // JR n
 int8_t opCode0x1f(Cpu* cpu){ // RRA
 	opcodes_rr(cpu, &(cpu->reg_a));
 	// RRA always clears Z flag (unlike CB RR which sets Z based on result)
-	clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	return PC_NO_JMP;
 }
 
@@ -211,7 +211,7 @@ int8_t opCode0x19(Cpu* cpu){ // ADD HL, DE
 
 int8_t opCode0x20(Cpu* cpu){ // JRNZ
 	int8_t addr_offset = get_one_byte_parameter(cpu);
-	uint8_t z_flag = get_bit( &(cpu->reg_f), FLAG_BIT_Z);
+	uint8_t z_flag = get_bit( cpu_flags(cpu), FLAG_BIT_Z);
 
 	if (! z_flag){
 		cpu->reg_pc += addr_offset + 2;
@@ -260,7 +260,7 @@ int8_t opCode0x26(Cpu* cpu){ // LD H, n
 int8_t opCode0x28(Cpu* cpu){ // JR Z, n
 	int8_t offset = get_one_byte_parameter(cpu);
 
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		cpu->reg_pc = cpu->reg_pc + 2 + offset;
 		cpu->cycles_left = 3; // Branch taken: 12 T-cycles = 3 M-cycles
 		return PC_JMP;
@@ -295,21 +295,21 @@ int8_t opCode0x27(Cpu* cpu){ // DAA
 	// DAA: Decimal Adjust Accumulator
 	uint16_t result = cpu->reg_a;
 
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_N)) {
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_N)) {
 		// After addition
-		if (get_bit(&(cpu->reg_f), FLAG_BIT_C) || cpu->reg_a > 0x99) {
+		if (get_bit(cpu_flags(cpu), FLAG_BIT_C) || cpu->reg_a > 0x99) {
 			result += 0x60;
-			set_bit(&(cpu->reg_f), FLAG_BIT_C);
+			set_bit(cpu_flags(cpu), FLAG_BIT_C);
 		}
-		if (get_bit(&(cpu->reg_f), FLAG_BIT_H) || (cpu->reg_a & 0x0F) > 0x09) {
+		if (get_bit(cpu_flags(cpu), FLAG_BIT_H) || (cpu->reg_a & 0x0F) > 0x09) {
 			result += 0x06;
 		}
 	} else {
 		// After subtraction
-		if (get_bit(&(cpu->reg_f), FLAG_BIT_C)) {
+		if (get_bit(cpu_flags(cpu), FLAG_BIT_C)) {
 			result -= 0x60;
 		}
-		if (get_bit(&(cpu->reg_f), FLAG_BIT_H)) {
+		if (get_bit(cpu_flags(cpu), FLAG_BIT_H)) {
 			result -= 0x06;
 		}
 	}
@@ -318,13 +318,13 @@ int8_t opCode0x27(Cpu* cpu){ // DAA
 
 	// Set Z flag if result is 0
 	if (cpu->reg_a == 0) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
 	// Clear H flag
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 
 	return PC_NO_JMP;
 }
@@ -345,15 +345,15 @@ int8_t opCode0x2f(Cpu* cpu){ // CPL
 	// CPL: Complement A (invert all bits)
 	// N=1, H=1, Z and C unchanged
 	cpu->reg_a = ~cpu->reg_a;
-	set_bit(&(cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	set_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0x30(Cpu* cpu){ // JR NC, n
 	int8_t offset = get_one_byte_parameter(cpu);
 
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		cpu->reg_pc = cpu->reg_pc + 2 + offset;
 		cpu->cycles_left = 3; // Branch taken: 12 T-cycles = 3 M-cycles
 		return PC_JMP;
@@ -404,9 +404,9 @@ int8_t opCode0x36(Cpu* cpu){ // LD (HL), n
 int8_t opCode0x37(Cpu* cpu){ // SCF
 	// SCF: Set Carry Flag
 	// N=0, H=0, C=1, Z unchanged
-	set_bit(&(cpu->reg_f), FLAG_BIT_C);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	set_bit(cpu_flags(cpu), FLAG_BIT_C);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
@@ -429,7 +429,7 @@ int8_t opCode0x3b(Cpu* cpu){ // DEC SP
 int8_t opCode0x38(Cpu* cpu){ // JR C, n
 	int8_t offset = get_one_byte_parameter(cpu);
 
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		cpu->reg_pc = cpu->reg_pc + 2 + offset;
 		cpu->cycles_left = 3; // Branch taken: 12 T-cycles = 3 M-cycles
 		return PC_JMP;
@@ -459,13 +459,13 @@ int8_t opCode0x3e(Cpu* cpu){ // LD A,n
 int8_t opCode0x3f(Cpu* cpu){ // CCF
 	// CCF: Complement Carry Flag
 	// N=0, H=0, C=!C, Z unchanged
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_C)) {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_C)) {
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
@@ -1118,7 +1118,7 @@ int8_t opCode0xbf(Cpu* cpu){ // CP A
 }
 
 int8_t opCode0xc0(Cpu* cpu){ // RET NZ
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		pop_stack(cpu, &(cpu->reg_pc));
 		cpu->cycles_left = 5; // Branch taken: 20 T-cycles = 5 M-cycles
 		return PC_JMP;
@@ -1134,7 +1134,7 @@ int8_t opCode0xc1(Cpu* cpu){ // POP BC
 
 int8_t opCode0xc2(Cpu* cpu){ // JP NZ, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 4; // Branch taken: 16 T-cycles = 4 M-cycles
 		return PC_JMP;
@@ -1151,7 +1151,7 @@ int8_t opCode0xc3(Cpu* cpu){ // JP nn
 
 int8_t opCode0xc4(Cpu* cpu){ // CALL NZ, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		push_stack(cpu, cpu->reg_pc + 3);
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 6; // Branch taken: 24 T-cycles = 6 M-cycles
@@ -1163,7 +1163,7 @@ int8_t opCode0xc4(Cpu* cpu){ // CALL NZ, nn
 
 int8_t opCode0xca(Cpu* cpu){ // JP Z, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 4; // Branch taken: 16 T-cycles = 4 M-cycles
 		return PC_JMP;
@@ -1174,7 +1174,7 @@ int8_t opCode0xca(Cpu* cpu){ // JP Z, nn
 
 int8_t opCode0xcc(Cpu* cpu){ // CALL Z, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		push_stack(cpu, cpu->reg_pc + 3);
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 6; // Branch taken: 24 T-cycles = 6 M-cycles
@@ -1214,7 +1214,7 @@ int8_t opCode0xc7(Cpu* cpu){ // RST 00H
 }
 
 int8_t opCode0xc8(Cpu* cpu){ // RET Z
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_Z)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_Z)){
 		pop_stack(cpu, &(cpu->reg_pc));
 		cpu->cycles_left = 5; // Branch taken: 20 T-cycles = 5 M-cycles
 		return PC_JMP;
@@ -1233,7 +1233,7 @@ int8_t opCode0xc9(Cpu* cpu){ // RET
 }
 
 int8_t opCode0xd0(Cpu* cpu){ // RET NC
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		pop_stack(cpu, &(cpu->reg_pc));
 		cpu->cycles_left = 5; // Branch taken: 20 T-cycles = 5 M-cycles
 		return PC_JMP;
@@ -1249,7 +1249,7 @@ int8_t opCode0xd1(Cpu* cpu){ // POP DE
 
 int8_t opCode0xd2(Cpu* cpu){ // JP NC, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 4; // Branch taken: 16 T-cycles = 4 M-cycles
 		return PC_JMP;
@@ -1260,7 +1260,7 @@ int8_t opCode0xd2(Cpu* cpu){ // JP NC, nn
 
 int8_t opCode0xd4(Cpu* cpu){ // CALL NC, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (!get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (!get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		push_stack(cpu, cpu->reg_pc + 3);
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 6; // Branch taken: 24 T-cycles = 6 M-cycles
@@ -1283,7 +1283,7 @@ int8_t opCode0xd7(Cpu* cpu){ // RST 10H
 }
 
 int8_t opCode0xd8(Cpu* cpu){ // RET C
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		pop_stack(cpu, &(cpu->reg_pc));
 		cpu->cycles_left = 5; // Branch taken: 20 T-cycles = 5 M-cycles
 		return PC_JMP;
@@ -1309,7 +1309,7 @@ int8_t opCode0xd9(Cpu* cpu){ // RETI
 
 int8_t opCode0xda(Cpu* cpu){ // JP C, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 4; // Branch taken: 16 T-cycles = 4 M-cycles
 		return PC_JMP;
@@ -1320,7 +1320,7 @@ int8_t opCode0xda(Cpu* cpu){ // JP C, nn
 
 int8_t opCode0xdc(Cpu* cpu){ // CALL C, nn
 	uint16_t addr = get_two_byte_parameter(cpu);
-	if (get_bit(&(cpu->reg_f), FLAG_BIT_C)){
+	if (get_bit(cpu_flags(cpu), FLAG_BIT_C)){
 		push_stack(cpu, cpu->reg_pc + 3);
 		cpu->reg_pc = addr;
 		cpu->cycles_left = 6; // Branch taken: 24 T-cycles = 6 M-cycles
@@ -1356,16 +1356,12 @@ int8_t opCode0xcd(Cpu* cpu){ // CALL n
 
 int8_t opCode0xe0(Cpu* cpu){ // LDH (n), A
 	uint8_t offset = get_one_byte_parameter(cpu);
-	uint16_t addr = 0xFF00 + offset;
-
-	write_to_ram(cpu->interconnect, addr, cpu->reg_a);
+	write_high_page(cpu->interconnect, offset, cpu->reg_a);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xe2(Cpu* cpu){ // LD(C), A
-	uint8_t value = cpu->reg_a;
-	uint16_t target = 0xFF00 + cpu->reg_c;
-	write_to_ram(cpu->interconnect, target, value);
+	write_high_page(cpu->interconnect, cpu->reg_c, cpu->reg_a);
 	return PC_NO_JMP;
 }
 
@@ -1391,21 +1387,21 @@ int8_t opCode0xe8(Cpu* cpu){ // ADD SP, n
 	uint32_t result = cpu->reg_sp + offset;
 
 	// Clear Z and N flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set H flag if carry from bit 3
 	if (((cpu->reg_sp & 0x0F) + (offset & 0x0F)) > 0x0F) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// Set C flag if carry from bit 7
 	if (((cpu->reg_sp & 0xFF) + (offset & 0xFF)) > 0xFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	cpu->reg_sp = (uint16_t)result;
@@ -1437,8 +1433,7 @@ int8_t opCode0xef(Cpu* cpu){ // RST 28H
 
 int8_t opCode0xf0(Cpu* cpu){ // LDH A, (n)
 	uint8_t offset = get_one_byte_parameter(cpu);
-	uint16_t addr = 0xFF00 + offset;
-	cpu->reg_a = read_from_ram(cpu->interconnect, addr);
+	cpu->reg_a = read_high_page(cpu->interconnect, offset);
 	return PC_NO_JMP;
 }
 
@@ -1446,6 +1441,9 @@ int8_t opCode0xf1(Cpu* cpu){ // POP AF
 	pop_stack(cpu, &(cpu->reg_af));
 	// Lower 4 bits of F register are always 0 on Game Boy
 	cpu->reg_f &= 0xF0;
+#ifdef LAZY_FLAGS
+	cpu->flag_op = FLAGOP_NONE;  // Popped F replaces any deferred flags
+#endif
 	return PC_NO_JMP;
 }
 
@@ -1455,6 +1453,7 @@ int8_t opCode0xf3(Cpu* cpu){ // DI (Disable Interrupts)
 }
 
 int8_t opCode0xf5(Cpu* cpu){ // PUSH AF
+	sync_flags(cpu);
 	push_stack(cpu, cpu->reg_af);
 	return PC_NO_JMP;
 }
@@ -1476,21 +1475,21 @@ int8_t opCode0xf8(Cpu* cpu){ // LD HL, SP+n
 	uint32_t result = cpu->reg_sp + offset;
 
 	// Clear Z and N flags
-	clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
 
 	// Set H flag if carry from bit 3
 	if (((cpu->reg_sp & 0x0F) + (offset & 0x0F)) > 0x0F) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_H);
+		set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_H);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_H);
 	}
 
 	// Set C flag if carry from bit 7
 	if (((cpu->reg_sp & 0xFF) + (offset & 0xFF)) > 0xFF) {
-		set_bit(&(cpu->reg_f), FLAG_BIT_C);
+		set_bit(cpu_flags(cpu), FLAG_BIT_C);
 	} else {
-		clear_bit(&(cpu->reg_f), FLAG_BIT_C);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_C);
 	}
 
 	cpu->reg_hl = (uint16_t)result;
@@ -1576,182 +1575,182 @@ int8_t opCode0xcb3f(Cpu* cpu){ // SRL A
 
 int8_t opCode0xcb40(Cpu* cpu){ // BIT 0, B
 	if ( ! get_bit(&(cpu->reg_b), 0) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb4c(Cpu* cpu){ // BIT 1, H
 	if ( ! get_bit(&(cpu->reg_h), 1) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb4f(Cpu* cpu){ // BIT 1, A
 	if ( ! get_bit(&(cpu->reg_a), 1) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb50(Cpu* cpu){ // BIT 2, B
 	if ( ! get_bit(&(cpu->reg_b), 2) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb58(Cpu* cpu){ // BIT 3, B
 	if ( ! get_bit(&(cpu->reg_b), 3) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb5f(Cpu* cpu){ // BIT 3, A
 	if ( ! get_bit(&(cpu->reg_a), 3) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb60(Cpu* cpu){ // BIT 4, B
 	if ( ! get_bit(&(cpu->reg_b), 4) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb68(Cpu* cpu){ // BIT 5, B
 	if ( ! get_bit(&(cpu->reg_b), 5) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb6f(Cpu* cpu){ // BIT 5, A
 	if ( ! get_bit(&(cpu->reg_a), 5) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb70(Cpu* cpu){ // BIT 6, B
 	if ( ! get_bit(&(cpu->reg_b), 6) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb77(Cpu* cpu){ // BIT 6, A
 	if ( ! get_bit(&(cpu->reg_a), 6) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb78(Cpu* cpu){ // BIT 7, B
 	if ( ! get_bit(&(cpu->reg_b), 7) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb7c(Cpu* cpu){ // BIT 7, H
 	if ( ! get_bit(&(cpu->reg_h), 7) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb7e(Cpu* cpu){ // BIT 7, (HL)
 	uint8_t value = read_from_ram(cpu->interconnect, cpu->reg_hl);
 	if ( ! get_bit(&value, 7) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
 int8_t opCode0xcb7f(Cpu* cpu){ // BIT 7, A
 	if ( ! get_bit(&(cpu->reg_a), 7) ){
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}else{
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z);
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z);
 	}
 
-	clear_bit(& (cpu->reg_f), FLAG_BIT_N);
-	set_bit(&(cpu->reg_f), FLAG_BIT_H);
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N);
+	set_bit(cpu_flags(cpu), FLAG_BIT_H);
 	return PC_NO_JMP;
 }
 
@@ -1889,23 +1888,23 @@ int8_t opCode0xcb3e(Cpu* cpu){
 // Helper macro for BIT instruction
 #define BIT_INSTR(bit, reg) \
 	if (!get_bit(&(cpu->reg), bit)) { \
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z); \
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z); \
 	} else { \
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z); \
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z); \
 	} \
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N); \
-	set_bit(&(cpu->reg_f), FLAG_BIT_H); \
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N); \
+	set_bit(cpu_flags(cpu), FLAG_BIT_H); \
 	return PC_NO_JMP;
 
 #define BIT_INSTR_HL(bit) \
 	uint8_t value = read_from_ram(cpu->interconnect, cpu->reg_hl); \
 	if (!get_bit(&value, bit)) { \
-		set_bit(&(cpu->reg_f), FLAG_BIT_Z); \
+		set_bit(cpu_flags(cpu), FLAG_BIT_Z); \
 	} else { \
-		clear_bit(&(cpu->reg_f), FLAG_BIT_Z); \
+		clear_bit(cpu_flags(cpu), FLAG_BIT_Z); \
 	} \
-	clear_bit(&(cpu->reg_f), FLAG_BIT_N); \
-	set_bit(&(cpu->reg_f), FLAG_BIT_H); \
+	clear_bit(cpu_flags(cpu), FLAG_BIT_N); \
+	set_bit(cpu_flags(cpu), FLAG_BIT_H); \
 	return PC_NO_JMP;
 
 // BIT 0,r (0x40-0x47)
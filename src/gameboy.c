@@ -0,0 +1,155 @@
+#include "gameboy.h"
+#include <stdlib.h>
+#include <string.h>
+
+void initialize_gameboy(GameBoy** gameboy){
+	*gameboy = (GameBoy*) aligned_alloc(_Alignof(GameBoy), sizeof(GameBoy));
+	initialize_gameboy_at(*gameboy);
+}
+
+void initialize_gameboy_at(GameBoy* gameboy){
+	initialize_cpu(&gameboy->cpu, &gameboy->interconnect);
+	initialize_ppu(&gameboy->ppu);
+	initialize_interconnect(&gameboy->interconnect, &gameboy->cpu, &gameboy->ppu);
+}
+
+// Sound registers after boot as they read back, 0xFF10-0xFF26
+static const uint8_t boot_sound_registers[0x17] = {
+	0x80, 0xBF, 0xF3, 0xFF, 0xBF, 0xFF, 0x3F, 0x00, 0xFF, 0xBF, 0x7F, 0xFF,
+	0x9F, 0xFF, 0xBF, 0xFF, 0xFF, 0x00, 0x00, 0xBF, 0x77, 0xF3, 0xF1,
+};
+
+// (R) tile the boot ROM draws after the logo, one byte per row
+static const uint8_t boot_registered_tile[8] = {0x3C, 0x42, 0xB9, 0xA5, 0xB9, 0xA5, 0x42, 0x3C};
+
+// Leaves the logo in VRAM like the boot ROM: the 48 header bytes at 0x0104 become
+// tiles 1-24, each nibble one row doubled in both directions, and the map shows
+// tiles 1-12 over 13-24 with the (R) tile 0x19 after the first row
+static void draw_boot_logo(Interconnect* interconnect, PPU* ppu){
+	uint8_t* tile = &ppu->vram[0x0010];
+	for (uint32_t i = 0; i < 48; i++){
+		uint8_t byte = interconnect->rom_size > 0x104 + i ? interconnect->rom[0x104 + i] : 0xFF;
+		for (int nibble = 0; nibble < 2; nibble++){
+			uint8_t bits = nibble ? byte & 0x0F : byte >> 4;
+			uint8_t row = 0;
+			for (int bit = 3; bit >= 0; bit--){
+				row = (row << 2) | (((bits >> bit) & 1) * 0x03);
+			}
+			tile[0] = row;
+			tile[2] = row;
+			tile += 4;
+		}
+	}
+	for (int i = 0; i < 8; i++){
+		ppu->vram[0x0190 + i * 2] = boot_registered_tile[i];
+	}
+
+	for (int i = 0; i < 12; i++){
+		ppu->vram[0x1904 + i] = 1 + i;
+		ppu->vram[0x1924 + i] = 13 + i;
+	}
+	ppu->vram[0x1910] = 0x19;
+	ppu_vram_written(ppu, 0, VRAM_SIZE);
+}
+
+void gameboy_skip_boot(GameBoy* gameboy){
+	Cpu* cpu = &gameboy->cpu;
+	Interconnect* interconnect = &gameboy->interconnect;
+	PPU* ppu = &gameboy->ppu;
+
+	cpu->reg_af = 0x01B0;
+	cpu->reg_bc = 0x0013;
+	cpu->reg_de = 0x00D8;
+	cpu->reg_hl = 0x014D;
+	cpu->reg_sp = 0xFFFE;
+	cpu->reg_pc = 0x0100;
+#ifdef LAZY_FLAGS
+	cpu->flag_op = FLAGOP_NONE;
+#endif
+
+	interconnect->inBios = FALSE;
+	interconnect->joyp = 0xCF;
+	interconnect->interrupt_flag = INT_VBLANK;  // Reads 0xE1
+	interconnect->high[0x02] = 0x7E;            // SC
+	memcpy(&interconnect->high[0x10], boot_sound_registers, sizeof(boot_sound_registers));
+
+	// The boot ROM takes the internal counter behind DIV to 0xABCC, which also
+	// sets the phase of TIMA once the timer is enabled
+	interconnect_set_divider(interconnect, 0xABCC);
+
+	// initialize_ppu() already holds the other register values the boot ROM leaves.
+	// It hands over during the last V-Blank line, which this PPU does not model
+	// separately, so the first frame simply starts at LY 0.
+	ppu->dma = 0xFF;
+	draw_boot_logo(interconnect, ppu);
+
+	rebuild_memory_map(interconnect);
+}
+
+size_t gameboy_state_size(const GameBoy* gameboy){
+	return sizeof(GameBoy) + gameboy->interconnect.eram_size;
+}
+
+void gameboy_save_state(const GameBoy* gameboy, uint8_t* snapshot){
+	memcpy(snapshot, gameboy, sizeof(GameBoy));
+	memcpy(snapshot + sizeof(GameBoy), gameboy->interconnect.eram, gameboy->interconnect.eram_size);
+}
+
+int gameboy_load_state(GameBoy* gameboy, const uint8_t* snapshot){
+	// The buffer may not be aligned for a GameBoy, read the field byte-wise
+	uint32_t saved_eram_size;
+	memcpy(&saved_eram_size, snapshot + offsetof(GameBoy, interconnect.eram_size), sizeof(saved_eram_size));
+	if (saved_eram_size != gameboy->interconnect.eram_size){
+		return 1;
+	}
+
+	// Per-instance fields that are not part of the machine state
+	Cpu* cpu = &gameboy->cpu;
+	int should_stop = cpu->should_stop;
+#ifdef BLOCK_CACHE
+	struct BlockCache_t* block_cache = cpu->block_cache;
+#endif
+#ifdef JIT
+	struct Jit_t* jit = cpu->jit;
+#endif
+	TileCache* tile_cache = gameboy->ppu.tile_cache;
+	MapCache* map_cache = gameboy->ppu.map_cache;
+	Interconnect* interconnect = &gameboy->interconnect;
+	const uint8_t* rom = interconnect->rom;
+	const uint8_t* bios = interconnect->bios;
+	uint8_t* eram = interconnect->eram;
+	uint8_t eram_file = interconnect->eram_file;
+
+	memcpy(gameboy, snapshot, sizeof(GameBoy));
+	memcpy(eram, snapshot + sizeof(GameBoy), interconnect->eram_size);
+
+	cpu->should_stop = should_stop;
+#ifdef BLOCK_CACHE
+	cpu->block_cache = block_cache;
+#endif
+#ifdef JIT
+	cpu->jit = jit;
+#endif
+	gameboy->ppu.tile_cache = tile_cache;
+	gameboy->ppu.map_cache = map_cache;
+	interconnect->rom = rom;
+	interconnect->bios = bios;
+	interconnect->eram = eram;
+	interconnect->eram_file = eram_file;
+
+	// The snapshot may come from another machine, point everything back inside
+	// this one
+	cpu->interconnect = interconnect;
+	interconnect->cpu = cpu;
+	interconnect->ppu = &gameboy->ppu;
+	rebuild_memory_map(interconnect);
+
+	// Memory changed without bumping any page generation or going through the
+	// VRAM write path
+	cpu_flush_caches(cpu);
+	ppu_flush_caches(&gameboy->ppu);
+
+	// The save file now holds the snapshot's RAM
+	mark_cartridge_ram_dirty(interconnect);
+	return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef GAMEBOY_H
+#define GAMEBOY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cpu.h"
+#include "interconnect.h"
+#include "ppu.h"
+
+#define CACHE_LINE_SIZE 64
+
+// The whole machine in one contiguous block. The CPU registers come first,
+// followed by the hot part of the interconnect (scheduler, interrupt and timer
+// registers, memory map), then RAM and the PPU. Components still reach each
+// other through their cpu/interconnect/ppu pointers, which all point inside
+// this block.
+//
+// Everything the emulation depends on lives here, except the cartridge RAM, so a
+// snapshot is one memcpy of the block plus one of the cartridge RAM. The ROM and
+// boot ROM are read-only and shared. The block cache, JIT buffer, decoded tiles
+// and tile map images are separate allocations: they only hold derived data and
+// are rebuilt after a snapshot is loaded.
+typedef struct GameBoy_t {
+	_Alignas(CACHE_LINE_SIZE) Cpu cpu;
+	Interconnect interconnect;
+	PPU ppu;
+} GameBoy;
+
+// Allocates and initializes a machine
+void initialize_gameboy(GameBoy** gameboy);
+// Initializes a machine in caller-provided memory, aligned to CACHE_LINE_SIZE
+void initialize_gameboy_at(GameBoy* gameboy);
+
+// Puts a machine with its cartridge loaded into the state the DMG boot ROM leaves
+// when it jumps to 0x0100, without needing the boot ROM image
+void gameboy_skip_boot(GameBoy* gameboy);
+
+// Mutable bytes per machine: the machine block plus its cartridge RAM. This is
+// also the size of a snapshot.
+size_t gameboy_state_size(const GameBoy* gameboy);
+
+// The CPU must not be running while a snapshot is taken or loaded. Snapshots can
+// be loaded into any machine built with the same options whose cartridge has the
+// same RAM size, loading returns 1 and leaves the machine untouched otherwise.
+void gameboy_save_state(const GameBoy* gameboy, uint8_t* snapshot);
+int gameboy_load_state(GameBoy* gameboy, const uint8_t* snapshot);
+
+#endif /* GAMEBOY_H */
@@ -4,244 +4,608 @@
 #include "util.h"
 #include "cpu.h"
 #include "ppu.h"
+#include "save_file.h"
 #include <assert.h>
 #include <stdio.h>
 
-void initialize_interconnect(Interconnect** interconnect, struct Cpu_t** cpu){
-	*interconnect = (Interconnect*) malloc(sizeof(Interconnect));
-	memset(*interconnect, 0, sizeof(Interconnect));
+static void sync_ppu(Interconnect* interconnect);
+static void sync_timer(Interconnect* interconnect);
+static void schedule_ppu_event(Interconnect* interconnect);
+static void schedule_timer_event(Interconnect* interconnect);
+static void start_oam_dma(Interconnect* interconnect);
+
+void initialize_interconnect(Interconnect* interconnect, struct Cpu_t* cpu, struct PPU_t* ppu){
 	// Initialize RAM to 0x00 for deterministic behavior (standard for most emulators)
 	// Real hardware has undefined RAM state, but 0x00 provides better compatibility
-	memset((*interconnect)->ram, 0x00, RAM_SIZE);
-	initialize_cpu(cpu, (*interconnect));
-	(*interconnect)->cpu = *cpu;
-	(*interconnect)->inBios = TRUE;
+	memset(interconnect, 0, sizeof(Interconnect));
+	interconnect->cpu = cpu;
+	interconnect->ppu = ppu;
+	interconnect->inBios = TRUE;
 
 	// Initialize interrupt registers
-	(*interconnect)->interrupt_flag = 0x00;
-	(*interconnect)->interrupt_enable = 0x00;
+	interconnect->interrupt_flag = 0x00;
+	interconnect->interrupt_enable = 0x00;
 
 	// Initialize timer registers
-	(*interconnect)->div = 0x00;
-	(*interconnect)->tima = 0x00;
-	(*interconnect)->tma = 0x00;
-	(*interconnect)->tac = 0x00;
-	(*interconnect)->div_counter = 0;
-	(*interconnect)->timer_counter = 0;
+	interconnect->div = 0x00;
+	interconnect->tima = 0x00;
+	interconnect->tma = 0x00;
+	interconnect->tac = 0x00;
+	interconnect->div_counter = 0;
+	interconnect->timer_counter = 0;
 
 	// Initialize joypad (all buttons released)
-	(*interconnect)->joyp = 0xFF;
-	(*interconnect)->button_a = 1;
-	(*interconnect)->button_b = 1;
-	(*interconnect)->button_start = 1;
-	(*interconnect)->button_select = 1;
-	(*interconnect)->button_up = 1;
-	(*interconnect)->button_down = 1;
-	(*interconnect)->button_left = 1;
-	(*interconnect)->button_right = 1;
-
-	// Initialize PPU
-	initialize_ppu(&((*interconnect)->ppu));
-}
-
-uint8_t read_from_ram(Interconnect* interconnect, uint16_t addr){
-	if (interconnect->inBios && interconnect->cpu->reg_pc >= 0x100){ // Init sequence complete, leaving bios
-		interconnect->inBios = FALSE;
-		debug_print("bios initialization complete%s", "\n");
+	interconnect->joyp = 0xFF;
+	interconnect->button_a = 1;
+	interconnect->button_b = 1;
+	interconnect->button_start = 1;
+	interconnect->button_select = 1;
+	interconnect->button_up = 1;
+	interconnect->button_down = 1;
+	interconnect->button_left = 1;
+	interconnect->button_right = 1;
+
+	rebuild_memory_map(interconnect);
+
+	// Initialize scheduler, the timer starts disabled so only the PPU has an event
+	initialize_scheduler(&interconnect->scheduler);
+	interconnect->ppu_synced_at = 0;
+	interconnect->timer_synced_at = 0;
+	schedule_ppu_event(interconnect);
+}
+
+// Fills the page tables from the current mapping state. Must be called whenever
+// something that decides what a page points to changes (e.g. leaving the bios)
+void rebuild_memory_map(Interconnect* interconnect){
+	remap_pages(interconnect, 0, PAGE_COUNT - 1);
+}
+
+void remap_pages(Interconnect* interconnect, int first, int last){
+	for (int page = first; page <= last; page++){
+		uint32_t offset = page * PAGE_SIZE;
+
+		if (page == 0 && interconnect->inBios){
+			// Boot ROM overlays the first page until 0xFF50 is written. The maps are
+			// never written through for read-only pages, hence the casts.
+			interconnect->read_map[page] = (uint8_t*) interconnect->bios;
+			interconnect->write_map[page] = NULL;
+		} else if (page < 0x80){
+			// Cartridge ROM (0x0000-0x7FFF) through the current banks, read-only,
+			// past its end reads 0xFF. Writes go to the bank controller.
+			uint32_t rom_offset = mbc_rom_offset(interconnect, offset);
+			interconnect->read_map[page] = rom_offset + PAGE_SIZE <= interconnect->rom_size ? (uint8_t*) &interconnect->rom[rom_offset] : NULL;
+			interconnect->write_map[page] = NULL;
+		} else if (page < 0xA0){
+			// VRAM (0x8000-0x9FFF), writes must sync the PPU first
+			interconnect->read_map[page] = &interconnect->ppu->vram[offset - 0x8000];
+			interconnect->write_map[page] = NULL;
+		} else if (page < 0xC0){
+			// Cartridge RAM bank (0xA000-0xBFFF), unmapped while disabled or past its size
+			uint8_t* host = mbc_eram_page(interconnect, page);
+			interconnect->read_map[page] = host;
+			interconnect->write_map[page] = host;
+		} else if (page < 0xFE){
+			// WRAM and echo RAM (0xC000-0xFDFF)
+			uint8_t* host = &interconnect->wram[offset & (WRAM_SIZE - 1)];
+			interconnect->read_map[page] = host;
+			interconnect->write_map[page] = host;
+		} else {
+			// OAM, I/O registers and HRAM (0xFE00-0xFFFF)
+			interconnect->read_map[page] = NULL;
+			interconnect->write_map[page] = NULL;
+		}
+
+		// OAM DMA owns the bus, see start_oam_dma()
+		if (interconnect->dma_active){
+			interconnect->read_map[page] = NULL;
+			interconnect->write_map[page] = NULL;
+		}
+
+#ifdef BLOCK_CACHE
+		if (interconnect->code_page[canonical_page(page)]){
+			interconnect->write_map[page] = NULL;
+		}
+#endif
 	}
+}
 
-	if (addr < 0x100 && interconnect->inBios){
-		return interconnect->bios[addr];
+// I/O registers with side effects or dedicated fields, one handler per register.
+// Everything else on the page (unhandled registers, HRAM) lives in high[].
+
+// Joypad register (0xFF00)
+static uint8_t io_read_joypad(Interconnect* interconnect, uint16_t addr){
+	uint8_t result = interconnect->joyp | 0xC0;  // Bits 7-6 always set
+
+	// Check which button group is selected
+	if (!(interconnect->joyp & 0x10)) {
+		// Direction keys selected (bit 4 = 0)
+		result &= 0xF0;  // Clear lower 4 bits
+		result |= (interconnect->button_right & 0x01) << 0;  // Right
+		result |= (interconnect->button_left & 0x01) << 1;   // Left
+		result |= (interconnect->button_up & 0x01) << 2;     // Up
+		result |= (interconnect->button_down & 0x01) << 3;   // Down
 	}
 
-	// VRAM (0x8000-0x9FFF)
-	if (addr >= 0x8000 && addr <= 0x9FFF){
-		return ppu_read_vram(interconnect->ppu, addr);
+	if (!(interconnect->joyp & 0x20)) {
+		// Button keys selected (bit 5 = 0)
+		result &= 0xF0;  // Clear lower 4 bits
+		result |= (interconnect->button_a & 0x01) << 0;      // A
+		result |= (interconnect->button_b & 0x01) << 1;      // B
+		result |= (interconnect->button_select & 0x01) << 2; // Select
+		result |= (interconnect->button_start & 0x01) << 3;  // Start
 	}
 
-	// OAM (0xFE00-0xFE9F)
-	if (addr >= 0xFE00 && addr <= 0xFE9F){
-		return ppu_read_oam(interconnect->ppu, addr);
+	return result;
+}
+
+static void io_write_joypad(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	// Only bits 5-4 are writable (select button group)
+	interconnect->joyp = (value & 0x30) | 0xCF;
+}
+
+// Timer registers (0xFF04-0xFF07)
+static uint8_t io_read_div(Interconnect* interconnect, uint16_t addr){
+	sync_timer(interconnect);
+	return interconnect->div;
+}
+
+static uint8_t io_read_tima(Interconnect* interconnect, uint16_t addr){
+	sync_timer(interconnect);
+	return interconnect->tima;
+}
+
+static uint8_t io_read_tma(Interconnect* interconnect, uint16_t addr){
+	return interconnect->tma;
+}
+
+static uint8_t io_read_tac(Interconnect* interconnect, uint16_t addr){
+	return interconnect->tac | 0xF8;  // Upper 5 bits always set
+}
+
+static void io_write_timer(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	sync_timer(interconnect);
+	if (addr == 0xFF04) {
+		// Writing to DIV resets it to 0
+		interconnect_set_divider(interconnect, 0);
+	} else if (addr == 0xFF05) {
+		interconnect->tima = value;
+	} else if (addr == 0xFF06) {
+		interconnect->tma = value;
+	} else {
+		interconnect->tac = value & 0x07;  // Only lower 3 bits are writable
+		interconnect_set_divider(interconnect, (interconnect->div << 8) | interconnect->div_counter);
 	}
+	// The next TIMA overflow moves with any of these registers
+	schedule_timer_event(interconnect);
+}
 
-	// Joypad register (0xFF00)
-	if (addr == 0xFF00) {
-		uint8_t result = interconnect->joyp | 0xC0;  // Bits 7-6 always set
+// Interrupt Flag (IF) - 0xFF0F
+static uint8_t io_read_if(Interconnect* interconnect, uint16_t addr){
+	return interconnect->interrupt_flag | 0xE0;  // Upper 3 bits always set
+}
 
-		// Check which button group is selected
-		if (!(interconnect->joyp & 0x10)) {
-			// Direction keys selected (bit 4 = 0)
-			result &= 0xF0;  // Clear lower 4 bits
-			result |= (interconnect->button_right & 0x01) << 0;  // Right
-			result |= (interconnect->button_left & 0x01) << 1;   // Left
-			result |= (interconnect->button_up & 0x01) << 2;     // Up
-			result |= (interconnect->button_down & 0x01) << 3;   // Down
-		}
+static void io_write_if(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	interconnect->interrupt_flag = value & 0x1F;  // Only lower 5 bits are writable
+}
 
-		if (!(interconnect->joyp & 0x20)) {
-			// Button keys selected (bit 5 = 0)
-			result &= 0xF0;  // Clear lower 4 bits
-			result |= (interconnect->button_a & 0x01) << 0;      // A
-			result |= (interconnect->button_b & 0x01) << 1;      // B
-			result |= (interconnect->button_select & 0x01) << 2; // Select
-			result |= (interconnect->button_start & 0x01) << 3;  // Start
-		}
+// LCD Registers (0xFF40-0xFF4B)
+static uint8_t io_read_lcd(Interconnect* interconnect, uint16_t addr){
+	sync_ppu(interconnect);
+	return ppu_read_register(interconnect->ppu, addr);
+}
+
+static void io_write_lcd(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	sync_ppu(interconnect);
+	ppu_write_register(interconnect->ppu, addr, value);
+	// LCDC/STAT writes may turn the LCD on or off
+	schedule_ppu_event(interconnect);
+}
+
+// OAM DMA (0xFF46), the register keeps the source page
+static void io_write_dma(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	interconnect->ppu->dma = value;
+	start_oam_dma(interconnect);
+}
 
-		return result;
+// Boot ROM disable (0xFF50), the bios writes it as its last instruction
+static void io_write_bios_disable(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	if (value && interconnect->inBios){
+		interconnect->inBios = FALSE;
+		rebuild_memory_map(interconnect);
+		debug_print("bios initialization complete%s", "\n");
 	}
+}
 
-	// LCD Registers (0xFF40-0xFF4B)
-	if (addr >= 0xFF40 && addr <= 0xFF4B){
-		return ppu_read_register(interconnect->ppu, addr);
+// Interrupt Enable (IE) - 0xFFFF
+static uint8_t io_read_ie(Interconnect* interconnect, uint16_t addr){
+	return interconnect->interrupt_enable;
+}
+
+static void io_write_ie(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	interconnect->interrupt_enable = value;
+}
+
+const IoReadHandler io_read_handlers[PAGE_SIZE] = {
+	[0x00] = io_read_joypad,
+	[0x04] = io_read_div,
+	[0x05] = io_read_tima,
+	[0x06] = io_read_tma,
+	[0x07] = io_read_tac,
+	[0x0F] = io_read_if,
+	[0x40] = io_read_lcd, [0x41] = io_read_lcd, [0x42] = io_read_lcd, [0x43] = io_read_lcd,
+	[0x44] = io_read_lcd, [0x45] = io_read_lcd, [0x46] = io_read_lcd, [0x47] = io_read_lcd,
+	[0x48] = io_read_lcd, [0x49] = io_read_lcd, [0x4A] = io_read_lcd, [0x4B] = io_read_lcd,
+	[0xFF] = io_read_ie,
+};
+
+const IoWriteHandler io_write_handlers[PAGE_SIZE] = {
+	[0x00] = io_write_joypad,
+	[0x04] = io_write_timer,
+	[0x05] = io_write_timer,
+	[0x06] = io_write_timer,
+	[0x07] = io_write_timer,
+	[0x0F] = io_write_if,
+	[0x40] = io_write_lcd, [0x41] = io_write_lcd, [0x42] = io_write_lcd, [0x43] = io_write_lcd,
+	[0x44] = io_write_lcd, [0x45] = io_write_lcd, [0x46] = io_write_dma, [0x47] = io_write_lcd,
+	[0x48] = io_write_lcd, [0x49] = io_write_lcd, [0x4A] = io_write_lcd, [0x4B] = io_write_lcd,
+	[0x50] = io_write_bios_disable,
+	[0xFF] = io_write_ie,
+};
+
+// Host byte behind an address without side effects below 0xFF00, NULL when nothing
+// is mapped there
+static uint8_t* plain_memory(Interconnect* interconnect, uint16_t addr){
+	if (addr >= 0xC000 && addr < 0xFE00){
+		return &interconnect->wram[addr & (WRAM_SIZE - 1)];
 	}
+	return NULL;
+}
 
-	// Timer registers (0xFF04-0xFF07)
-	if (addr == 0xFF04) {
-		return interconnect->div;
+// Reads from pages without a direct host mapping
+uint8_t read_from_ram_slow(Interconnect* interconnect, uint16_t addr){
+	// I/O registers and HRAM, the only memory reachable during OAM DMA
+	if (addr >= 0xFF00){
+		return read_high_page(interconnect, addr & 0xFF);
+	}
+	if (interconnect->dma_active){
+		return 0xFF;
 	}
-	if (addr == 0xFF05) return interconnect->tima;
-	if (addr == 0xFF06) return interconnect->tma;
-	if (addr == 0xFF07) return interconnect->tac | 0xF8;  // Upper 5 bits always set
 
-	// Interrupt Flag (IF) - 0xFF0F
-	if (addr == 0xFF0F){
-		return interconnect->interrupt_flag | 0xE0;  // Upper 3 bits always set
+	// OAM (0xFE00-0xFE9F)
+	if (addr >= 0xFE00 && addr <= 0xFE9F){
+		return ppu_read_oam(interconnect->ppu, addr);
 	}
 
-	// Interrupt Enable (IE) - 0xFFFF
-	if (addr == 0xFFFF){
-		return interconnect->interrupt_enable;
+	// Clock registers, disabled or missing cartridge RAM
+	if (addr >= 0xA000 && addr < 0xC000){
+		return mbc_read_eram(interconnect, addr);
 	}
 
-	return interconnect->ram[addr];
+	uint8_t* byte = plain_memory(interconnect, addr);
+	if (byte){
+		return *byte;
+	}
+
+	// Boot ROM without an image, or ROM past the end of the image
+	if (addr < BIOS_SIZE && interconnect->inBios){
+		return 0x00;
+	}
+	if (addr < ROM_WINDOW){
+		uint32_t rom_offset = mbc_rom_offset(interconnect, addr);
+		return rom_offset < interconnect->rom_size ? interconnect->rom[rom_offset] : 0xFF;
+	}
+
+	// Unusable area (0xFEA0-0xFEFF) reads 0x00
+	return addr >= 0xFEA0 ? 0x00 : 0xFF;
 }
 
-inline uint16_t read_addr_from_ram(Interconnect* interconnect, uint16_t addr)
+// Writes to pages without a direct host mapping
+void write_to_ram_slow(Interconnect* interconnect, uint16_t addr, uint8_t value)
 {
-	return   (read_from_ram(interconnect, addr+1) << 8) | (read_from_ram(interconnect, addr) );
-}
+	if (addr >= 0xFF00){
+		write_high_page(interconnect, addr & 0xFF, value);
+		return;
+	}
+	if (interconnect->dma_active){
+		return;
+	}
+
+#ifdef BLOCK_CACHE
+	// Self-modifying code: invalidate the blocks decoded from this page
+	uint8_t page = canonical_page(addr >> 8);
+	if (interconnect->code_page[page]){
+		interconnect->page_generation[page]++;
+		interconnect->block_exit = 1;
+	}
+#endif
+
+	// Cartridge ROM (0x0000-0x7FFF) is read-only, writes program the bank controller
+	if (addr < 0x8000){
+#ifdef BLOCK_CACHE
+		interconnect->block_exit = 1;  // The running block may come from the old bank
+#endif
+		mbc_write(interconnect, addr, value);
+		return;
+	}
 
+	// Cartridge RAM (0xA000-0xBFFF) pages without a host mapping
+	if (addr >= 0xA000 && addr < 0xC000){
+		mbc_write_eram(interconnect, addr, value);
+		return;
+	}
 
-void write_to_ram(Interconnect* interconnect, uint16_t addr, uint8_t value)
-{
 	// VRAM (0x8000-0x9FFF)
 	if (addr >= 0x8000 && addr <= 0x9FFF){
+		sync_ppu(interconnect);
 		ppu_write_vram(interconnect->ppu, addr, value);
 		return;
 	}
 
 	// OAM (0xFE00-0xFE9F)
 	if (addr >= 0xFE00 && addr <= 0xFE9F){
+		sync_ppu(interconnect);
 		ppu_write_oam(interconnect->ppu, addr, value);
 		return;
 	}
 
-	// Joypad register (0xFF00)
-	if (addr == 0xFF00) {
-		// Only bits 5-4 are writable (select button group)
-		interconnect->joyp = (value & 0x30) | 0xCF;
-		return;
+	// Anything else without side effects, writes to unmapped areas are dropped
+	uint8_t* byte = plain_memory(interconnect, addr);
+	if (byte){
+		*byte = value;
 	}
+}
 
-	// LCD Registers (0xFF40-0xFF4B)
-	if (addr >= 0xFF40 && addr <= 0xFF4B){
-		ppu_write_register(interconnect->ppu, addr, value);
-		return;
+void load_dmg_rom(Interconnect* interconnect, uint64_t romLen, const unsigned char* rom){
+	debug_print("mapping bios rom%s", "\n");
+	assert(romLen == BIOS_SIZE);
+	interconnect->bios = rom;
+	rebuild_memory_map(interconnect);
+}
+
+// Cartridge RAM size from header byte 0x149
+static uint32_t cartridge_ram_size(uint8_t code){
+	switch (code){
+		case 0x01: return 0x800;
+		case 0x02: return 0x2000;
+		case 0x03: return 0x8000;
+		case 0x04: return 0x20000;
+		case 0x05: return 0x10000;
+		default: return 0;
 	}
+}
 
-	// Timer registers (0xFF04-0xFF07)
-	if (addr == 0xFF04) {
-		// Writing to DIV resets it to 0
-		interconnect->div = 0;
-		interconnect->div_counter = 0;
-		return;
+void load_cartridge_rom(Interconnect* interconnect, uint64_t romLen, const unsigned char* rom){
+	debug_print("loading cartridge rom, size: %llu bytes%s", romLen, "\n");
+
+	interconnect->rom = rom;
+	interconnect->rom_size = romLen < UINT32_MAX ? (uint32_t) romLen : UINT32_MAX;
+
+	detach_save_file(interconnect);
+	free(interconnect->eram);
+	interconnect->eram_size = romLen > 0x149 ? cartridge_ram_size(rom[0x149]) : 0;
+	interconnect->eram = interconnect->eram_size ? (uint8_t*) calloc(1, interconnect->eram_size) : NULL;
+
+	mbc_initialize(interconnect);
+	rebuild_memory_map(interconnect);
+	debug_print("cartridge rom mapped at address 0x0000%s", "\n");
+}
+
+int attach_save_file(Interconnect* interconnect, const char* path){
+	if (!interconnect->mbc.has_battery || interconnect->eram_size == 0){
+		return 0;
 	}
-	if (addr == 0xFF05) {
-		interconnect->tima = value;
+
+	uint8_t* data = save_file_open(path, interconnect->eram_size);
+	if (!data){
+		return 1;
+	}
+	detach_save_file(interconnect);
+	free(interconnect->eram);
+	interconnect->eram = data;
+	interconnect->eram_file = 1;
+	interconnect->eram_dirty = 0;
+
+	// Cartridge RAM pages point into the old buffer
+	remap_pages(interconnect, 0xA0, 0xBF);
+	if (interconnect->mbc.ram_enabled){
+		mark_cartridge_ram_dirty(interconnect);
+	}
+	return 0;
+}
+
+void detach_save_file(Interconnect* interconnect){
+	if (!interconnect->eram_file){
 		return;
 	}
-	if (addr == 0xFF06) {
-		interconnect->tma = value;
+	save_file_close(interconnect->eram, interconnect->eram_size);
+	interconnect->eram = NULL;
+	interconnect->eram_size = 0;
+	interconnect->eram_file = 0;
+	interconnect->eram_dirty = 0;
+	scheduler_cancel(&interconnect->scheduler, EVENT_SAVE);
+	remap_pages(interconnect, 0xA0, 0xBF);
+}
+
+void mark_cartridge_ram_dirty(Interconnect* interconnect){
+	if (!interconnect->eram_file){
 		return;
 	}
-	if (addr == 0xFF07) {
-		interconnect->tac = value & 0x07;  // Only lower 3 bits are writable
+	interconnect->eram_dirty = 1;
+	if (interconnect->scheduler.slot[EVENT_SAVE] < 0){
+		scheduler_schedule(&interconnect->scheduler, EVENT_SAVE, interconnect->scheduler.now + SAVE_FLUSH_INTERVAL);
+	}
+}
+
+void flush_cartridge_ram(Interconnect* interconnect){
+	if (!interconnect->eram_file || !interconnect->eram_dirty){
 		return;
 	}
+	save_file_flush(interconnect->eram, interconnect->eram_size);
+	interconnect->eram_dirty = 0;
+}
+
+// Timer period in T-cycles selected by TAC bits 0-1
+static uint16_t timer_threshold(uint8_t tac){
+	switch (tac & 0x03) {
+		case 0: return 1024;  // 4096 Hz
+		case 1: return 16;    // 262144 Hz
+		case 2: return 64;    // 65536 Hz
+		default: return 256;  // 16384 Hz
+	}
+}
+
+// Update timer registers - called with number of T-cycles elapsed, any amount at once
+void timer_step(Interconnect* interconnect, uint64_t cycles) {
+	// Update DIV register (increments at 16384 Hz = every 256 T-cycles)
+	uint64_t div_total = interconnect->div_counter + cycles;
+	interconnect->div += (uint8_t)(div_total / 256);
+	interconnect->div_counter = div_total % 256;
 
-	// Interrupt Flag (IF) - 0xFF0F
-	if (addr == 0xFF0F){
-		interconnect->interrupt_flag = value & 0x1F;  // Only lower 5 bits are writable
+	// Check if timer is enabled (bit 2 of TAC)
+	if (!(interconnect->tac & 0x04)) {
 		return;
 	}
 
-	// Interrupt Enable (IE) - 0xFFFF
-	if (addr == 0xFFFF){
-		interconnect->interrupt_enable = value;
+	// Update TIMA
+	uint16_t threshold = timer_threshold(interconnect->tac);
+	uint64_t timer_total = interconnect->timer_counter + cycles;
+	uint64_t ticks = timer_total / threshold;
+	interconnect->timer_counter = timer_total % threshold;
+
+	if (ticks < (uint64_t)(256 - interconnect->tima)) {
+		interconnect->tima += ticks;
 		return;
 	}
 
-	interconnect->ram[addr] = value;
+	// TIMA overflowed (possibly several times), reload from TMA and trigger interrupt
+	ticks -= 256 - interconnect->tima;
+	interconnect->tima = interconnect->tma + ticks % (256 - interconnect->tma);
+	interconnect->interrupt_flag |= INT_TIMER;
 }
 
-void write_addr_to_ram(Interconnect* interconnect, uint16_t addr, uint16_t value){
-	write_to_ram(interconnect, addr+1, value >> 8);
-	write_to_ram(interconnect, addr, value & 0x00FF);
+// TIMA counts the overflows of the low bits of the same counter, so the timer
+// counter is that counter modulo the selected period
+void interconnect_set_divider(Interconnect* interconnect, uint16_t counter){
+	interconnect->div = counter >> 8;
+	interconnect->div_counter = counter & 0xFF;
+	interconnect->timer_counter = counter % timer_threshold(interconnect->tac);
 }
 
-void load_dmg_rom(Interconnect* interconnect, uint64_t romLen, unsigned char* rom){
-	debug_print("mapping bios rom%s", "\n");
-	assert(romLen == 256);
-	memcpy(interconnect->bios, rom, romLen);
-}
+// Catch the PPU up to the current timestamp
+static void sync_ppu(Interconnect* interconnect){
+	uint64_t now = interconnect->scheduler.now;
+	if (now == interconnect->ppu_synced_at){
+		return;
+	}
 
-void load_cartridge_rom(Interconnect* interconnect, uint64_t romLen, unsigned char* rom){
-	debug_print("loading cartridge rom, size: %llu bytes%s", romLen, "\n");
+	// While the LCD is on the PPU event keeps the gap below one scanline,
+	// while it is off ppu_step ignores the cycles anyway
+	ppu_step(interconnect->ppu, (uint32_t)(now - interconnect->ppu_synced_at));
+	interconnect->ppu_synced_at = now;
 
-	if (romLen > RAM_SIZE){
-		fprintf(stderr, "Warning: ROM size (%llu bytes) exceeds addressable memory (%d bytes). Truncating.\n", romLen, RAM_SIZE);
-		romLen = RAM_SIZE;
+	if (interconnect->ppu->vblank_interrupt_requested) {
+		interconnect->ppu->vblank_interrupt_requested = 0;
+		interconnect->interrupt_flag |= INT_VBLANK;
+	}
+}
+
+// Catch DIV/TIMA up to the current timestamp
+static void sync_timer(Interconnect* interconnect){
+	uint64_t now = interconnect->scheduler.now;
+	if (now == interconnect->timer_synced_at){
+		return;
 	}
 
-	memcpy(interconnect->ram, rom, romLen);
-	debug_print("cartridge rom loaded to address 0x0000%s", "\n");
+	timer_step(interconnect, now - interconnect->timer_synced_at);
+	interconnect->timer_synced_at = now;
 }
 
-// Update timer registers - called with number of T-cycles elapsed
-void timer_step(Interconnect* interconnect, uint32_t cycles) {
-	// Update DIV register (increments at 16384 Hz = every 256 T-cycles)
-	interconnect->div_counter += cycles;
-	while (interconnect->div_counter >= 256) {
-		interconnect->div_counter -= 256;
-		interconnect->div++;
+static void schedule_ppu_event(Interconnect* interconnect){
+	uint32_t cycles = ppu_cycles_to_next_mode(interconnect->ppu);
+	if (cycles == 0){
+		scheduler_cancel(&interconnect->scheduler, EVENT_PPU);
+		return;
 	}
+	scheduler_schedule(&interconnect->scheduler, EVENT_PPU, interconnect->scheduler.now + cycles);
+}
 
-	// Check if timer is enabled (bit 2 of TAC)
+// Predicts the next TIMA overflow, the timer must already be synced
+static void schedule_timer_event(Interconnect* interconnect){
 	if (!(interconnect->tac & 0x04)) {
+		scheduler_cancel(&interconnect->scheduler, EVENT_TIMER);
 		return;
 	}
 
-	// Determine timer frequency based on TAC bits 0-1
-	uint16_t timer_threshold;
-	switch (interconnect->tac & 0x03) {
-		case 0: timer_threshold = 1024; break;  // 4096 Hz
-		case 1: timer_threshold = 16;   break;  // 262144 Hz
-		case 2: timer_threshold = 64;   break;  // 65536 Hz
-		case 3: timer_threshold = 256;  break;  // 16384 Hz
-		default: timer_threshold = 1024; break;
+	uint64_t now = interconnect->scheduler.now;
+	uint64_t cycles_to_overflow = (uint64_t)(256 - interconnect->tima) * timer_threshold(interconnect->tac);
+
+	// After a TAC change the counter may already hold more than the remaining ticks
+	uint64_t deadline = now;
+	if (cycles_to_overflow > interconnect->timer_counter){
+		deadline += cycles_to_overflow - interconnect->timer_counter;
 	}
+	scheduler_schedule(&interconnect->scheduler, EVENT_TIMER, deadline);
+}
 
-	// Update TIMA
-	interconnect->timer_counter += cycles;
-	while (interconnect->timer_counter >= timer_threshold) {
-		interconnect->timer_counter -= timer_threshold;
-		interconnect->tima++;
-
-		// Check for overflow
-		if (interconnect->tima == 0) {
-			// TIMA overflowed, reload from TMA and trigger interrupt
-			interconnect->tima = interconnect->tma;
-			interconnect->interrupt_flag |= INT_TIMER;
+// OAM DMA copies 160 bytes from the source page to OAM over 160 M-cycles, while the
+// CPU can only reach I/O and HRAM. Rather than moving a byte per cycle, the memory
+// map is unmapped for the duration and the whole copy happens when EVENT_DMA fires.
+// The CPU cannot write the source in between, so the bytes are the same.
+static void start_oam_dma(Interconnect* interconnect){
+	interconnect->dma_active = 1;
+	rebuild_memory_map(interconnect);
+	scheduler_schedule(&interconnect->scheduler, EVENT_DMA, interconnect->scheduler.now + OAM_DMA_CYCLES);
+}
+
+static void finish_oam_dma(Interconnect* interconnect){
+	interconnect->dma_active = 0;
+	rebuild_memory_map(interconnect);
+
+	// The PPU renders with the old table up to now
+	sync_ppu(interconnect);
+
+	// Sources past 0xDFFF read echo RAM, also for 0xFE and 0xFF
+	uint16_t source = interconnect->ppu->dma << 8;
+	if (source >= 0xFE00){
+		source -= 0x2000;
+	}
+	uint8_t* page = interconnect->read_map[source >> 8];
+	if (page){
+		memcpy(interconnect->ppu->oam, page, OAM_SIZE);
+	} else {
+		for (int i = 0; i < OAM_SIZE; i++){
+			interconnect->ppu->oam[i] = read_from_ram_slow(interconnect, source + i);
 		}
 	}
+	ppu_oam_written(interconnect->ppu);
+}
+
+// Brings all lazily stepped components up to the current timestamp
+void interconnect_sync(Interconnect* interconnect){
+	sync_ppu(interconnect);
+	sync_timer(interconnect);
+}
+
+// Called by the run loop for every due event but EVENT_FRAME
+void interconnect_handle_event(Interconnect* interconnect, uint8_t type){
+	switch (type) {
+		case EVENT_PPU:
+			sync_ppu(interconnect);
+			schedule_ppu_event(interconnect);
+			break;
+		case EVENT_TIMER:
+			sync_timer(interconnect);
+			schedule_timer_event(interconnect);
+			break;
+		case EVENT_DMA:
+			finish_oam_dma(interconnect);
+			break;
+		case EVENT_SAVE:
+			// Games that keep the RAM enabled still get flushed regularly
+			flush_cartridge_ram(interconnect);
+			if (interconnect->mbc.ram_enabled){
+				mark_cartridge_ram_dirty(interconnect);
+			}
+			break;
+	}
 }
@@ -1,10 +1,19 @@
 #ifndef INTERCONNECT_H
 #define INTERCONNECT_H
-#define RAM_SIZE 65536 //Addressable Memory
 #define BIOS_SIZE 256
+#define ROM_WINDOW 0x8000    // Cartridge ROM visible at 0x0000-0x7FFF
+#define ERAM_WINDOW 0x2000   // Cartridge RAM visible at 0xA000-0xBFFF
+#define WRAM_SIZE 0x2000     // 0xC000-0xDFFF, mirrored at 0xE000-0xFDFF
+#define PAGE_SIZE 256   // Granularity of the memory map
+#define PAGE_COUNT 256
 
 #include <stdint.h>
 #include "ppu.h"
+#include "scheduler.h"
+#include "mbc.h"
+
+#define SAVE_FLUSH_INTERVAL CYCLES_PER_SECOND  // Flush period while cartridge RAM stays enabled
+#define OAM_DMA_CYCLES (160 * 4)               // T-cycles of an OAM DMA transfer
 
 // Interrupt bits
 #define INT_VBLANK  0x01  // Bit 0: V-Blank
@@ -13,12 +22,17 @@
 #define INT_SERIAL  0x08  // Bit 3: Serial
 #define INT_JOYPAD  0x10  // Bit 4: Joypad
 
+// Hot fields first: the run loop touches the scheduler, the interrupt registers
+// and the timer on every instruction, the memory map on every access. The large
+// arrays come last so those stay within the first cache lines of GameBoy.
 typedef struct Interconnect_t{
-	uint8_t ram[RAM_SIZE];
-	uint8_t bios[BIOS_SIZE];
 	struct Cpu_t* cpu;
 	struct PPU_t* ppu;
+#ifdef BLOCK_CACHE
+	uint8_t block_exit;  // Set by writes the running block must stop after
+#endif
 	uint8_t inBios;
+	uint8_t dma_active;        // OAM DMA running, the CPU only reaches 0xFF00-0xFFFF
 	uint8_t interrupt_flag;    // IF register (0xFF0F)
 	uint8_t interrupt_enable;  // IE register (0xFFFF)
 
@@ -30,6 +44,11 @@ typedef struct Interconnect_t{
 	uint16_t div_counter;   // Internal counter for DIV
 	uint16_t timer_counter; // Internal counter for TIMA
 
+	// Event scheduling, the PPU and timer only catch up to scheduler.now when observed
+	Scheduler scheduler;
+	uint64_t ppu_synced_at;    // Timestamp the PPU was last stepped to
+	uint64_t timer_synced_at;  // Timestamp the timer was last stepped to
+
 	// Joypad state (0xFF00)
 	uint8_t joyp;  // 0xFF00 - Joypad register
 	// Button states (0 = pressed, 1 = not pressed)
@@ -41,21 +60,138 @@ typedef struct Interconnect_t{
 	uint8_t button_down;
 	uint8_t button_left;
 	uint8_t button_right;
+
+	Mbc mbc;  // Cartridge bank controller, see mbc.h
+
+	// Memory map: host pointer to the start of each 256-byte page, NULL when the
+	// page has side effects and must go through read_from_ram_slow/write_to_ram_slow
+	uint8_t* read_map[PAGE_COUNT];
+	uint8_t* write_map[PAGE_COUNT];
+
+#ifdef BLOCK_CACHE
+	// Pages holding cached RAM code, kept off the direct write map so writes can
+	// invalidate their blocks by bumping the generation
+	uint8_t code_page[PAGE_COUNT];
+	uint32_t page_generation[PAGE_COUNT];
+#endif
+
+	// Read-only images, owned by the caller and shareable between machines
+	const uint8_t* rom;
+	uint32_t rom_size;
+	const uint8_t* bios;  // NULL when no boot ROM was loaded
+
+	// Cartridge RAM, allocated by load_cartridge_rom() from the header's size.
+	// Kept out of the machine block since it can be far larger than everything else.
+	uint8_t* eram;
+	uint32_t eram_size;
+	uint8_t eram_file;   // eram is a mapped save file, see attach_save_file()
+	uint8_t eram_dirty;  // RAM was enabled since the last flush of the save file
+
+	uint8_t wram[WRAM_SIZE];
+	uint8_t high[PAGE_SIZE];  // Backing bytes of 0xFF00-0xFFFF: HRAM and I/O registers without handlers
 } Interconnect;
 
 
-void initialize_interconnect(Interconnect** interconnect, struct Cpu_t** cpu);
-void load_dmg_rom(Interconnect* interconnect, uint64_t romLen, unsigned char* rom);
-void load_cartridge_rom(Interconnect* interconnect, uint64_t romLen, unsigned char* rom);
+// Sets up an interconnect in place, cpu and ppu must already be initialized
+void initialize_interconnect(Interconnect* interconnect, struct Cpu_t* cpu, struct PPU_t* ppu);
+// Both images are used in place, they must outlive the interconnect
+void load_dmg_rom(Interconnect* interconnect, uint64_t romLen, const unsigned char* rom);
+void load_cartridge_rom(Interconnect* interconnect, uint64_t romLen, const unsigned char* rom);
+
+// Backs the RAM of a battery-backed cartridge with the save file at path, after
+// load_cartridge_rom() and before running. Returns 1 if the file cannot be mapped, the RAM then
+// stays in memory only. Does nothing for cartridges without a battery.
+int attach_save_file(Interconnect* interconnect, const char* path);
+// Writes the save file back and unmaps it, the RAM is gone afterwards
+void detach_save_file(Interconnect* interconnect);
+// Save file writes are batched: RAM enables mark it dirty and schedule
+// EVENT_SAVE, RAM disables and the event flush it
+void mark_cartridge_ram_dirty(Interconnect* interconnect);
+void flush_cartridge_ram(Interconnect* interconnect);
+
+void rebuild_memory_map(Interconnect* interconnect);
+// Same for pages first to last only (bank switches)
+void remap_pages(Interconnect* interconnect, int first, int last);
+
+// Echo RAM (0xE000-0xFDFF) shows the WRAM pages 0x2000 below it. Per-page state
+// that follows the host memory (code pages and their generations) is indexed by
+// the WRAM page for both views.
+static inline uint8_t canonical_page(uint8_t page){
+	return page >= 0xE0 && page < 0xFE ? page - 0x20 : page;
+}
+
+uint8_t read_from_ram_slow(Interconnect* interconnect, uint16_t addr);
+void write_to_ram_slow(Interconnect* interconnect, uint16_t addr, uint8_t value);
+
+static inline uint8_t read_from_ram(Interconnect* interconnect, uint16_t addr){
+	uint8_t* page = interconnect->read_map[addr >> 8];
+	if (page){
+		return page[addr & 0xFF];
+	}
+	return read_from_ram_slow(interconnect, addr);
+}
+
+static inline uint16_t read_addr_from_ram(Interconnect* interconnect, uint16_t addr){
+	return (read_from_ram(interconnect, addr+1) << 8) | read_from_ram(interconnect, addr);
+}
+
+static inline void write_to_ram(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	uint8_t* page = interconnect->write_map[addr >> 8];
+	if (page){
+		page[addr & 0xFF] = value;
+		return;
+	}
+	write_to_ram_slow(interconnect, addr, value);
+}
+
+static inline void write_addr_to_ram(Interconnect* interconnect, uint16_t addr, uint16_t value){
+	write_to_ram(interconnect, addr+1, value >> 8);
+	write_to_ram(interconnect, addr, value & 0x00FF);
+}
+
+// The high page (0xFF00-0xFFFF) is never on the memory map. Each register is
+// dispatched through one table lookup instead of a chain of range checks, and a
+// NULL entry means the byte in high[] (HRAM, registers without side effects).
+// LDH and LD (C) come straight here.
+typedef uint8_t (*IoReadHandler)(Interconnect* interconnect, uint16_t addr);
+typedef void (*IoWriteHandler)(Interconnect* interconnect, uint16_t addr, uint8_t value);
+extern const IoReadHandler io_read_handlers[PAGE_SIZE];
+extern const IoWriteHandler io_write_handlers[PAGE_SIZE];
 
-uint8_t read_from_ram(Interconnect* interconnect, uint16_t addr);
-uint16_t read_addr_from_ram(Interconnect* interconnect, uint16_t addr);
+static inline uint8_t read_high_page(Interconnect* interconnect, uint8_t offset){
+	IoReadHandler handler = io_read_handlers[offset];
+	if (handler){
+		return handler(interconnect, 0xFF00 | offset);
+	}
+	return interconnect->high[offset];
+}
 
-void write_to_ram(Interconnect* interconnect, uint16_t addr, uint8_t value);
+static inline void write_high_page(Interconnect* interconnect, uint8_t offset, uint8_t value){
+#ifdef BLOCK_CACHE
+	// Self-modifying code in HRAM
+	if (interconnect->code_page[0xFF]){
+		interconnect->page_generation[0xFF]++;
+		interconnect->block_exit = 1;
+	}
+#endif
+	IoWriteHandler handler = io_write_handlers[offset];
+	if (handler){
+#ifdef BLOCK_CACHE
+		// Register writes may raise IF/IE, move an event or remap memory
+		interconnect->block_exit = 1;
+#endif
+		handler(interconnect, 0xFF00 | offset, value);
+		return;
+	}
+	interconnect->high[offset] = value;
+}
 
-void write_addr_to_ram(Interconnect* interconnect, uint16_t addr, uint16_t value);
+void timer_step(Interconnect* interconnect, uint64_t cycles);
+// Sets the internal 16-bit counter whose upper byte DIV shows, TIMA's phase follows it
+void interconnect_set_divider(Interconnect* interconnect, uint16_t counter);
 
-void timer_step(Interconnect* interconnect, uint32_t cycles);
+void interconnect_sync(Interconnect* interconnect);
+void interconnect_handle_event(Interconnect* interconnect, uint8_t type);
 
 #endif /*INTERCONNECT_H*/
 
@@ -0,0 +1,500 @@
+#ifndef JIT_H
+#define JIT_H
+
+// x86-64 dynamic recompiler, enabled at build time with JIT=1 (implies BLOCK_CACHE).
+// Blocks from the block cache that have run JIT_HOT_THRESHOLD times are translated
+// to native code:
+//  - Register moves, 8 bit ALU ops, INC/DEC and immediate loads are emitted inline,
+//    operating on the Cpu struct through rbx. Z/H/C come from the host flags via
+//    lahf and a lookup table.
+//  - Everything else (memory access, stack, CB ops, control flow) calls the
+//    interpreter handler, so behaviour is shared with the other cores.
+//  - Time and instruction_count are only flushed before call-outs and at exits.
+//    After every call-out the block exits if interconnect->block_exit was set.
+// A native block follows exactly the run_block() contract. jit_run() then chains
+// into the next native block as long as the run loop would have nothing to do at
+// that instruction boundary (no due event, no pending interrupt, no idle loop
+// candidate, no HALT/EI).
+//
+// JIT_VERIFY runs every native block a second time through the interpreter from
+// the same Cpu/Interconnect/PPU state and aborts on the first difference.
+//
+// On other hosts, or if executable memory cannot be mapped, blocks simply keep
+// running through the block cache interpreter. Only included by block_cache.h.
+
+#ifdef LAZY_FLAGS
+#error "JIT reads and writes reg_f directly and does not support LAZY_FLAGS"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define JIT_BUFFER_SIZE (4 * 1024 * 1024)
+#define JIT_HOT_THRESHOLD 8
+
+#if defined(__x86_64__) && !defined(DEBUG)
+#define JIT_SUPPORTED 1
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+typedef uint16_t (*JitFunction)(Cpu* cpu, Interconnect* interconnect);
+
+typedef struct Jit_t {
+	uint8_t* buffer;     // Executable code buffer, NULL when the JIT is unavailable
+	size_t used;
+#ifdef JIT_VERIFY
+	Cpu cpu_before, cpu_native;
+	Interconnect interconnect_before, interconnect_native;
+	PPU ppu_before, ppu_native;
+#endif
+} Jit;
+
+// Host registers
+#define JIT_RAX 0
+#define JIT_RCX 1
+#define JIT_RDX 2
+#define JIT_RBX 3  // Cpu*
+#define JIT_RBP 5  // Interconnect*
+
+#define JIT_CPU(field) ((int32_t)offsetof(Cpu, field))
+#define JIT_IC(field)  ((int32_t)offsetof(Interconnect, field))
+
+// Worst case bytes per instruction, including its exit stub
+#define JIT_MAX_INSTRUCTION_BYTES 160
+
+// Guest register number (as encoded in opcodes) to Cpu offset, (HL) has none
+static const int32_t jit_register_offset[8] = {
+	JIT_CPU(reg_b), JIT_CPU(reg_c), JIT_CPU(reg_d), JIT_CPU(reg_e),
+	JIT_CPU(reg_h), JIT_CPU(reg_l), -1, JIT_CPU(reg_a)
+};
+
+static const int32_t jit_pair_offset[4] = {
+	JIT_CPU(reg_bc), JIT_CPU(reg_de), JIT_CPU(reg_hl), JIT_CPU(reg_sp)
+};
+
+// lahf result (SF ZF - AF - PF - CF) to Game Boy Z/N/H/C
+static uint8_t jit_flags_add[256];
+static uint8_t jit_flags_sub[256];
+static uint8_t jit_flags_inc[256];
+static uint8_t jit_flags_dec[256];
+
+typedef struct JitExit_t {
+	size_t patch;          // rel32 of the jne to this exit
+	uint16_t pc;           // PC of the instruction after which the block stops
+	uint16_t next_pc;
+	uint8_t cycles;        // Cycles of that instruction, left in cycles_left
+	uint32_t time;         // T-cycles to add to the timestamp
+	uint32_t count;        // Instructions to add to instruction_count
+} JitExit;
+
+static void initialize_jit(Jit** jit){
+	*jit = (Jit*) calloc(1, sizeof(Jit));
+
+	for (int ah = 0; ah < 256; ah++){
+		uint8_t flags = 0;
+		if (ah & 0x40) flags |= 0x80;  // ZF -> Z
+		if (ah & 0x10) flags |= 0x20;  // AF -> H
+		jit_flags_inc[ah] = flags;
+		jit_flags_dec[ah] = flags | 0x40;
+		if (ah & 0x01) flags |= 0x10;  // CF -> C
+		jit_flags_add[ah] = flags;
+		jit_flags_sub[ah] = flags | 0x40;
+	}
+
+#if JIT_SUPPORTED
+	void* buffer = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffer == MAP_FAILED){
+		fprintf(stderr, "JIT: could not map executable memory, using the interpreter\n");
+		return;
+	}
+	(*jit)->buffer = (uint8_t*) buffer;
+#endif
+}
+
+static inline void jit_emit8(Jit* jit, uint8_t value){
+	jit->buffer[jit->used++] = value;
+}
+
+static inline void jit_emit16(Jit* jit, uint16_t value){
+	jit_emit8(jit, value & 0xFF);
+	jit_emit8(jit, value >> 8);
+}
+
+static inline void jit_emit32(Jit* jit, uint32_t value){
+	jit_emit16(jit, value & 0xFFFF);
+	jit_emit16(jit, value >> 16);
+}
+
+static inline void jit_emit64(Jit* jit, uint64_t value){
+	jit_emit32(jit, value & 0xFFFFFFFF);
+	jit_emit32(jit, value >> 32);
+}
+
+// ModRM for [base + disp32]
+static inline void jit_emit_mem(Jit* jit, uint8_t reg, uint8_t base, int32_t disp){
+	jit_emit8(jit, 0x80 | (reg << 3) | base);
+	jit_emit32(jit, (uint32_t)disp);
+}
+
+// add qword [base + disp], imm32
+static void jit_emit_add64(Jit* jit, uint8_t base, int32_t disp, uint32_t value){
+	if (value == 0){
+		return;
+	}
+	jit_emit8(jit, 0x48);
+	jit_emit8(jit, 0x81);
+	jit_emit_mem(jit, 0, base, disp);
+	jit_emit32(jit, value);
+}
+
+static void jit_emit_store16(Jit* jit, int32_t disp, uint16_t value){
+	jit_emit8(jit, 0x66);
+	jit_emit8(jit, 0xC7);
+	jit_emit_mem(jit, 0, JIT_RBX, disp);
+	jit_emit16(jit, value);
+}
+
+static void jit_emit_store8(Jit* jit, int32_t disp, uint8_t value){
+	jit_emit8(jit, 0xC6);
+	jit_emit_mem(jit, 0, JIT_RBX, disp);
+	jit_emit8(jit, value);
+}
+
+// mov eax, pc; add rsp, 8; pop rbp; pop rbx; ret
+static void jit_emit_return(Jit* jit, uint16_t pc){
+	jit_emit8(jit, 0xB8);
+	jit_emit32(jit, pc);
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x83); jit_emit8(jit, 0xC4); jit_emit8(jit, 0x08);
+	jit_emit8(jit, 0x5D);
+	jit_emit8(jit, 0x5B);
+	jit_emit8(jit, 0xC3);
+}
+
+// Converts the host flags to Z/N/H/C through a table and merges them into reg_f,
+// keeping the bits selected by keep_mask
+static void jit_emit_flags_from_table(Jit* jit, uint8_t* table, uint8_t keep_mask){
+	jit_emit8(jit, 0x9F);                                            // lahf
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0xB6); jit_emit8(jit, 0xCC); // movzx ecx, ah
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xBA);                      // mov rdx, table
+	jit_emit64(jit, (uint64_t)(uintptr_t)table);
+	jit_emit8(jit, 0x8A); jit_emit8(jit, 0x0C); jit_emit8(jit, 0x0A); // mov cl, [rdx + rcx]
+	jit_emit8(jit, 0x8A); jit_emit_mem(jit, JIT_RDX, JIT_RBX, JIT_CPU(reg_f)); // mov dl, [f]
+	jit_emit8(jit, 0x80); jit_emit8(jit, 0xE2); jit_emit8(jit, keep_mask);     // and dl, keep_mask
+	jit_emit8(jit, 0x08); jit_emit8(jit, 0xD1);                      // or cl, dl
+	jit_emit8(jit, 0x88); jit_emit_mem(jit, JIT_RCX, JIT_RBX, JIT_CPU(reg_f)); // mov [f], cl
+}
+
+// Z from the host zero flag plus constant N/H/C bits (logic ops)
+static void jit_emit_flags_from_zero(Jit* jit, uint8_t constant){
+	jit_emit8(jit, 0x0F); jit_emit8(jit, 0x94); jit_emit8(jit, 0xC1); // setz cl
+	jit_emit8(jit, 0xC0); jit_emit8(jit, 0xE1); jit_emit8(jit, 0x07); // shl cl, 7
+	if (constant){
+		jit_emit8(jit, 0x80); jit_emit8(jit, 0xC9); jit_emit8(jit, constant); // or cl, constant
+	}
+	jit_emit8(jit, 0x8A); jit_emit_mem(jit, JIT_RDX, JIT_RBX, JIT_CPU(reg_f)); // mov dl, [f]
+	jit_emit8(jit, 0x80); jit_emit8(jit, 0xE2); jit_emit8(jit, 0x0F);          // and dl, 0x0F
+	jit_emit8(jit, 0x08); jit_emit8(jit, 0xD1);                                // or cl, dl
+	jit_emit8(jit, 0x88); jit_emit_mem(jit, JIT_RCX, JIT_RBX, JIT_CPU(reg_f)); // mov [f], cl
+}
+
+// ADD/ADC/SUB/SBC/AND/XOR/OR/CP A, source (kind as encoded in bits 3-5)
+static void jit_emit_alu(Jit* jit, uint8_t kind, int32_t source, int immediate, uint8_t value){
+	static const uint8_t memory_ops[8] = {0x02, 0x12, 0x2A, 0x1A, 0x22, 0x32, 0x0A, 0x3A};
+	static const uint8_t immediate_ops[8] = {0x04, 0x14, 0x2C, 0x1C, 0x24, 0x34, 0x0C, 0x3C};
+
+	jit_emit8(jit, 0x8A); jit_emit_mem(jit, JIT_RAX, JIT_RBX, JIT_CPU(reg_a));     // mov al, [a]
+
+	if (kind == 1 || kind == 3){
+		// Load the guest carry into CF for adc/sbb
+		jit_emit8(jit, 0x8A); jit_emit_mem(jit, JIT_RCX, JIT_RBX, JIT_CPU(reg_f)); // mov cl, [f]
+		jit_emit8(jit, 0xC0); jit_emit8(jit, 0xE1); jit_emit8(jit, 0x04);          // shl cl, 4
+	}
+
+	if (immediate){
+		jit_emit8(jit, immediate_ops[kind]);
+		jit_emit8(jit, value);
+	} else {
+		jit_emit8(jit, memory_ops[kind]);
+		jit_emit_mem(jit, JIT_RAX, JIT_RBX, source);
+	}
+
+	if (kind != 7){
+		jit_emit8(jit, 0x88); jit_emit_mem(jit, JIT_RAX, JIT_RBX, JIT_CPU(reg_a)); // mov [a], al
+	}
+
+	switch (kind){
+		case 0: case 1: jit_emit_flags_from_table(jit, jit_flags_add, 0x0F); break;
+		case 2: case 3: case 7: jit_emit_flags_from_table(jit, jit_flags_sub, 0x0F); break;
+		case 4: jit_emit_flags_from_zero(jit, 0x20); break;
+		default: jit_emit_flags_from_zero(jit, 0x00); break;
+	}
+}
+
+// Emits the instruction inline if it is in the natively supported subset
+static int jit_emit_native(Jit* jit, DecodedInstruction* decoded){
+	if (decoded->prefix){
+		return 0;
+	}
+
+	uint8_t opcode = (uint8_t)decoded->opcode;
+	uint8_t high = (opcode >> 3) & 0x07;
+	uint8_t low = opcode & 0x07;
+
+	if (opcode == 0x00){
+		return 1;  // NOP
+	}
+
+	if (opcode >= 0x40 && opcode <= 0x7F){
+		// LD r, r'
+		if (high == 6 || low == 6){
+			return 0;
+		}
+		if (high != low){
+			jit_emit8(jit, 0x8A); jit_emit_mem(jit, JIT_RAX, JIT_RBX, jit_register_offset[low]);  // mov al, [src]
+			jit_emit8(jit, 0x88); jit_emit_mem(jit, JIT_RAX, JIT_RBX, jit_register_offset[high]); // mov [dst], al
+		}
+		return 1;
+	}
+
+	if (opcode >= 0x80 && opcode <= 0xBF){
+		// ALU A, r
+		if (low == 6){
+			return 0;
+		}
+		jit_emit_alu(jit, high, jit_register_offset[low], 0, 0);
+		return 1;
+	}
+
+	if ((opcode & 0xC7) == 0xC6){
+		// ALU A, n
+		jit_emit_alu(jit, high, 0, 1, (uint8_t)decoded->operand);
+		return 1;
+	}
+
+	if ((opcode & 0xC7) == 0x06 && high != 6){
+		// LD r, n
+		jit_emit_store8(jit, jit_register_offset[high], (uint8_t)decoded->operand);
+		return 1;
+	}
+
+	if ((opcode & 0xCF) == 0x01){
+		// LD rr, nn
+		jit_emit_store16(jit, jit_pair_offset[opcode >> 4], decoded->operand);
+		return 1;
+	}
+
+	if ((opcode & 0xC7) == 0x03){
+		// INC rr / DEC rr, no flags
+		jit_emit8(jit, 0x66);
+		jit_emit8(jit, 0xFF);
+		jit_emit_mem(jit, (opcode & 0x08) ? 1 : 0, JIT_RBX, jit_pair_offset[opcode >> 4]);
+		return 1;
+	}
+
+	if (((opcode & 0xC7) == 0x04 || (opcode & 0xC7) == 0x05) && high != 6){
+		// INC r / DEC r, C is kept
+		int dec = opcode & 0x01;
+		jit_emit8(jit, 0xFE);
+		jit_emit_mem(jit, dec ? 1 : 0, JIT_RBX, jit_register_offset[high]);
+		jit_emit_flags_from_table(jit, dec ? jit_flags_dec : jit_flags_inc, 0x1F);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Sets PC/operand and calls the interpreter handler, result in al
+static void jit_emit_call(Jit* jit, DecodedInstruction* decoded, uint16_t pc){
+	jit_emit_store16(jit, JIT_CPU(reg_pc), pc + decoded->prefix);
+	if (decoded->length > 1){
+		jit_emit_store16(jit, JIT_CPU(operand), decoded->operand);
+	}
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x89); jit_emit8(jit, 0xDF);  // mov rdi, rbx
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0xB8);                        // mov rax, handler
+	jit_emit64(jit, (uint64_t)(uintptr_t)decoded->execute);
+	jit_emit8(jit, 0xFF); jit_emit8(jit, 0xD0);                        // call rax
+}
+
+static void jit_flush(Cpu* cpu){
+	for (int i = 0; i < BLOCK_CACHE_ENTRIES; i++){
+		cpu->block_cache->blocks[i].native = NULL;
+	}
+	cpu->jit->used = 0;
+}
+
+static void jit_compile(Cpu* cpu, Block* block){
+	Jit* jit = cpu->jit;
+	if (!jit->buffer){
+		return;
+	}
+
+	if (jit->used + (block->count + 1) * JIT_MAX_INSTRUCTION_BYTES > JIT_BUFFER_SIZE){
+		jit_flush(cpu);
+	}
+
+	uint8_t* start = jit->buffer + jit->used;
+	JitExit exits[BLOCK_MAX_INSTRUCTIONS];
+	int exit_count = 0;
+	uint32_t time = 0;   // T-cycles not yet added to the timestamp
+	uint32_t count = 0;  // Instructions not yet added to instruction_count
+	uint16_t pc = block->start;
+
+	// push rbx; push rbp; sub rsp, 8; mov rbx, rdi; mov rbp, rsi; block_exit = 0
+	jit_emit8(jit, 0x53);
+	jit_emit8(jit, 0x55);
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x83); jit_emit8(jit, 0xEC); jit_emit8(jit, 0x08);
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x89); jit_emit8(jit, 0xFB);
+	jit_emit8(jit, 0x48); jit_emit8(jit, 0x89); jit_emit8(jit, 0xF5);
+	jit_emit8(jit, 0xC6); jit_emit_mem(jit, 0, JIT_RBP, JIT_IC(block_exit)); jit_emit8(jit, 0);
+
+	for (int i = 0; i < block->count; i++){
+		DecodedInstruction* decoded = &block->instructions[i];
+		uint16_t next_pc = pc + decoded->prefix + decoded->length;
+
+		if (i == block->count - 1){
+			// Last instruction: its cycles are left to the run loop
+			jit_emit_add64(jit, JIT_RBP, JIT_IC(scheduler.now), time);
+			jit_emit_add64(jit, JIT_RBX, JIT_CPU(instruction_count), count + 1);
+
+			if (jit_emit_native(jit, decoded)){
+				jit_emit_store16(jit, JIT_CPU(reg_pc), next_pc);
+				jit_emit_store8(jit, JIT_CPU(cycles_left), decoded->cycles);
+			} else {
+				jit_emit_call(jit, decoded, pc);
+				// if (!jmp_occured) pc += length
+				jit_emit8(jit, 0x84); jit_emit8(jit, 0xC0);  // test al, al
+				jit_emit8(jit, 0x75); jit_emit8(jit, 0x09);  // jnz +9
+				jit_emit8(jit, 0x66); jit_emit8(jit, 0x81);
+				jit_emit_mem(jit, 0, JIT_RBX, JIT_CPU(reg_pc));
+				jit_emit16(jit, decoded->length);
+				// if (cycles_left == 0) cycles_left = default
+				jit_emit8(jit, 0x80); jit_emit_mem(jit, 7, JIT_RBX, JIT_CPU(cycles_left)); jit_emit8(jit, 0);
+				jit_emit8(jit, 0x75); jit_emit8(jit, 0x07);  // jne +7
+				jit_emit_store8(jit, JIT_CPU(cycles_left), decoded->cycles);
+			}
+			jit_emit_return(jit, pc);
+			break;
+		}
+
+		if (!jit_emit_native(jit, decoded)){
+			// Call-outs see the exact timestamp and may end the block
+			jit_emit_add64(jit, JIT_RBP, JIT_IC(scheduler.now), time);
+			time = 0;
+			jit_emit_call(jit, decoded, pc);
+
+			jit_emit8(jit, 0x80); jit_emit_mem(jit, 7, JIT_RBP, JIT_IC(block_exit)); jit_emit8(jit, 0);
+			jit_emit8(jit, 0x0F); jit_emit8(jit, 0x85);  // jne exit
+			exits[exit_count].patch = jit->used;
+			jit_emit32(jit, 0);
+			exits[exit_count].pc = pc;
+			exits[exit_count].next_pc = next_pc;
+			exits[exit_count].cycles = decoded->cycles;
+			exits[exit_count].time = 0;
+			exits[exit_count].count = count + 1;
+			exit_count++;
+		}
+
+		time += decoded->cycles * 4;
+		count++;
+		pc = next_pc;
+	}
+
+	// Early exits after a call-out that set block_exit
+	for (int i = 0; i < exit_count; i++){
+		JitExit* exit = &exits[i];
+		uint32_t rel = (uint32_t)(jit->used - (exit->patch + 4));
+		memcpy(&jit->buffer[exit->patch], &rel, sizeof(rel));
+
+		jit_emit_add64(jit, JIT_RBX, JIT_CPU(instruction_count), exit->count);
+		jit_emit_store16(jit, JIT_CPU(reg_pc), exit->next_pc);
+		jit_emit_store8(jit, JIT_CPU(cycles_left), exit->cycles);
+		jit_emit_return(jit, exit->pc);
+	}
+
+	block->native = start;
+}
+
+#ifdef JIT_VERIFY
+static void jit_report_mismatch(Block* block, Cpu* native, Cpu* interpreted){
+	fprintf(stderr, "JIT mismatch in block 0x%04x (bank %u, %d instructions)\n", block->start, block->bank, block->count);
+	Cpu* cpus[2] = {native, interpreted};
+	const char* names[2] = {"native", "interpreter"};
+	for (int i = 0; i < 2; i++){
+		fprintf(stderr, "  %-11s AF=%04x BC=%04x DE=%04x HL=%04x SP=%04x PC=%04x cycles_left=%u count=%llu\n",
+			names[i], cpus[i]->reg_af, cpus[i]->reg_bc, cpus[i]->reg_de, cpus[i]->reg_hl,
+			cpus[i]->reg_sp, cpus[i]->reg_pc, cpus[i]->cycles_left, (unsigned long long)cpus[i]->instruction_count);
+	}
+	abort();
+}
+
+static int jit_cpu_equal(Cpu* a, Cpu* b){
+	return a->reg_af == b->reg_af && a->reg_bc == b->reg_bc && a->reg_de == b->reg_de &&
+	       a->reg_hl == b->reg_hl && a->reg_sp == b->reg_sp && a->reg_pc == b->reg_pc &&
+	       a->cycles_left == b->cycles_left && a->instruction_count == b->instruction_count &&
+	       a->ime == b->ime && a->ime_scheduled == b->ime_scheduled &&
+	       a->halted == b->halted && a->in_interrupt == b->in_interrupt;
+}
+
+static uint16_t block_interpret(Cpu* cpu, Block* block);
+
+// Runs the block natively, then again through the interpreter from the same state
+static uint16_t jit_verify(Cpu* cpu, Block* block, JitFunction function){
+	Jit* jit = cpu->jit;
+	Interconnect* interconnect = cpu->interconnect;
+	PPU* ppu = interconnect->ppu;
+
+	jit->cpu_before = *cpu;
+	jit->interconnect_before = *interconnect;
+	jit->ppu_before = *ppu;
+
+	uint16_t native_pc = function(cpu, interconnect);
+	jit->cpu_native = *cpu;
+	jit->interconnect_native = *interconnect;
+	jit->ppu_native = *ppu;
+
+	*cpu = jit->cpu_before;
+	*interconnect = jit->interconnect_before;
+	*ppu = jit->ppu_before;
+
+	uint16_t pc = block_interpret(cpu, block);
+
+	if (pc != native_pc || !jit_cpu_equal(&jit->cpu_native, cpu) ||
+	    memcmp(&jit->interconnect_native, interconnect, sizeof(Interconnect)) != 0 ||
+	    memcmp(&jit->ppu_native, ppu, sizeof(PPU)) != 0){
+		jit_report_mismatch(block, &jit->cpu_native, cpu);
+	}
+	return pc;
+}
+#endif
+
+static inline uint16_t jit_execute(Cpu* cpu, Block* block){
+	JitFunction function = (JitFunction)(uintptr_t)block->native;
+#ifdef JIT_VERIFY
+	return jit_verify(cpu, block, function);
+#else
+	return function(cpu, cpu->interconnect);
+#endif
+}
+
+// Runs a native block and keeps chaining into the following native blocks while the
+// run loop would do nothing but advance time at the boundary in between
+static uint16_t jit_run(Cpu* cpu, Block* block){
+	Scheduler* scheduler = &cpu->interconnect->scheduler;
+
+	while (1){
+		uint16_t pc = jit_execute(cpu, block);
+
+		Block* next = block_chain(cpu, pc);
+		if (!next || !next->native){
+			return pc;
+		}
+
+		scheduler->now += cpu->cycles_left * 4;
+		cpu->cycles_left = 0;
+		block = next;
+	}
+}
+
+#endif /* JIT_H */
@@ -7,8 +7,20 @@
 #include "util.h"
 #include "cpu.h"
 #include "interconnect.h"
+#include "gameboy.h"
+#include "rom_cache.h"
 #include "video.h"
 
+// Save file next to the ROM: the ROM path with its extension replaced by .sav
+static void save_file_path(const char* rom_path, char* path, size_t size){
+    snprintf(path, size, "%s", rom_path);
+    char* extension = strrchr(path, '.');
+    if (!extension || strchr(extension, '/')){
+        extension = path + strlen(path);
+    }
+    snprintf(extension, size - (extension - path), ".sav");
+}
+
 #ifdef DEBUG
 void sigterm_handler(int signum){
 	fprintf(stderr, "\nReceived signal %d (SIGTERM), printing last instructions...\n", signum);
@@ -18,31 +30,47 @@ void sigterm_handler(int signum){
 #endif
 
 int main(int argc, const char* argv[]){
-    if(argc != 2) {
-        fprintf(stderr, "Usage: %s <rom_file>\n", argv[0]);
+    // --skip-boot starts the cartridge directly in the state the boot ROM leaves
+    int skipBoot = argc == 3 && strcmp(argv[1], "--skip-boot") == 0;
+    if(argc != 2 && !skipBoot) {
+        fprintf(stderr, "Usage: %s [--skip-boot] <rom_file>\n", argv[0]);
         fprintf(stderr, "Use 'make debug' to build with debug output enabled\n");
         return 1;
     }
+    const char* romPath = argv[argc - 1];
 
+    // Mapped read-only and shared, see rom_cache.h
     uint64_t romFileLen = 0;
-    unsigned char* rom = NULL;
-
-    uint64_t dmgRomFileLen = 0;
-    unsigned char* dmgRom = NULL;
+    const unsigned char* rom = rom_cache_open(romPath, &romFileLen);
+    if (!rom) {
+        return 1;
+    }
 
-    read_from_disk("roms/DMG_ROM.bin", &dmgRomFileLen, &dmgRom);
+    GameBoy* gameboy = NULL;
+    initialize_gameboy(&gameboy);
+    Interconnect* interconnect = &gameboy->interconnect;
+    Cpu* cpu = &gameboy->cpu;
 
-    read_from_disk(argv[1], &romFileLen, &rom);
+    load_cartridge_rom(interconnect, romFileLen, rom);
 
-    Interconnect* interconnect = NULL;
-    Cpu* cpu = NULL;
-    initialize_interconnect(&interconnect, &cpu);
+    if (skipBoot) {
+        gameboy_skip_boot(gameboy);
+    } else {
+        uint64_t dmgRomFileLen = 0;
+        const unsigned char* dmgRom = rom_cache_open("roms/DMG_ROM.bin", &dmgRomFileLen);
+        if (!dmgRom) {
+            fprintf(stderr, "The boot ROM is needed unless --skip-boot is given\n");
+            return 1;
+        }
+        load_dmg_rom(interconnect, dmgRomFileLen, dmgRom);
+    }
 
-    load_cartridge_rom(interconnect, romFileLen, rom);
-    free(rom);
+    // Battery-backed RAM is written straight into the save file
+    char savePath[4096];
+    save_file_path(romPath, savePath, sizeof(savePath));
+    attach_save_file(interconnect, savePath);
 
-    load_dmg_rom(interconnect, dmgRomFileLen, dmgRom);
-    free(dmgRom);
+    fprintf(stderr, "Machine state: %zu bytes per instance\n", gameboy_state_size(gameboy));
 
 #ifdef DEBUG
     signal(SIGTERM, sigterm_handler);
@@ -63,6 +91,8 @@ int main(int argc, const char* argv[]){
     pthread_join(cpu_thread, NULL);
     fprintf(stderr, "CPU thread stopped cleanly.\n");
 
+    detach_save_file(interconnect);
+
     free(video);
 
     return 0;
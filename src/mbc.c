@@ -0,0 +1,297 @@
+#include "mbc.h"
+#include <stdio.h>
+#include "interconnect.h"
+
+// Controller and clock from cartridge type byte 0x147
+static void mbc_detect(Mbc* mbc, uint8_t type){
+	mbc->has_rtc = 0;
+	switch (type){
+		case 0x03: case 0x09: case 0x0F: case 0x10: case 0x13: case 0x1B: case 0x1E:
+			mbc->has_battery = 1;
+			break;
+		default:
+			mbc->has_battery = 0;
+			break;
+	}
+
+	switch (type){
+		case 0x00: case 0x08: case 0x09:
+			mbc->type = MBC_NONE;
+			break;
+		case 0x01: case 0x02: case 0x03:
+			mbc->type = MBC_1;
+			break;
+		case 0x0F: case 0x10:
+			mbc->has_rtc = 1;
+			mbc->type = MBC_3;
+			break;
+		case 0x11: case 0x12: case 0x13:
+			mbc->type = MBC_3;
+			break;
+		case 0x19: case 0x1A: case 0x1B: case 0x1C: case 0x1D: case 0x1E:
+			mbc->type = MBC_5;
+			break;
+		default:
+			fprintf(stderr, "Warning: cartridge type 0x%02x is not supported, running it without a bank controller.\n", type);
+			mbc->type = MBC_NONE;
+			break;
+	}
+}
+
+static int mbc_rtc_selected(const Mbc* mbc){
+	return mbc->has_rtc && mbc->ram_select >= RTC_SELECT_FIRST && mbc->ram_select < RTC_SELECT_FIRST + RTC_REGISTERS;
+}
+
+// Recomputes the mapped banks from the registers and re-points the pages that
+// changed, so accesses through mapped banks never look at the registers
+static void mbc_update(Interconnect* interconnect){
+	Mbc* mbc = &interconnect->mbc;
+	uint16_t bank_low = 0;
+	uint16_t bank_high = 1;
+	uint8_t ram_bank = 0;
+
+	switch (mbc->type){
+		case MBC_1:
+			// Bank 0 of the 5-bit register reads as 1, the 2-bit register adds the
+			// upper ROM bits, and in mode 1 also banks 0x0000 and the RAM
+			bank_high = ((mbc->ram_select & 0x03) << 5) | ((mbc->rom_select & 0x1F) ? (mbc->rom_select & 0x1F) : 1);
+			if (mbc->mode){
+				bank_low = (mbc->ram_select & 0x03) << 5;
+				ram_bank = mbc->ram_select & 0x03;
+			}
+			break;
+		case MBC_3:
+			bank_high = (mbc->rom_select & 0x7F) ? (mbc->rom_select & 0x7F) : 1;
+			ram_bank = mbc->ram_select & 0x07;
+			break;
+		case MBC_5:
+			bank_high = mbc->rom_select & 0x1FF;
+			ram_bank = mbc->ram_select & 0x0F;
+			break;
+		default:
+			break;
+	}
+	bank_low %= mbc->rom_banks;
+	bank_high %= mbc->rom_banks;
+
+	if (bank_low != mbc->bank_low){
+		mbc->bank_low = bank_low;
+		remap_pages(interconnect, 0x00, 0x3F);
+	}
+	if (bank_high != mbc->bank_high){
+		mbc->bank_high = bank_high;
+		remap_pages(interconnect, 0x40, 0x7F);
+	}
+
+	// RAM enable, bank and clock selection all change what 0xA000-0xBFFF shows
+	mbc->ram_bank = ram_bank;
+	if (mbc_eram_page(interconnect, 0xA0) != interconnect->read_map[0xA0]){
+		remap_pages(interconnect, 0xA0, 0xBF);
+#ifdef BLOCK_CACHE
+		// Code decoded from the previous bank must not run from the new one
+		for (int page = 0xA0; page <= 0xBF; page++){
+			interconnect->page_generation[page]++;
+		}
+#endif
+	}
+}
+
+void mbc_initialize(Interconnect* interconnect){
+	Mbc* mbc = &interconnect->mbc;
+	*mbc = (Mbc){0};
+	mbc_detect(mbc, interconnect->rom_size > 0x147 ? interconnect->rom[0x147] : 0x00);
+
+	mbc->rom_banks = (interconnect->rom_size + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE;
+	if (mbc->rom_banks < 2){
+		mbc->rom_banks = 2;
+	}
+	if (mbc->type == MBC_NONE){
+		if (interconnect->rom_size > ROM_WINDOW){
+			fprintf(stderr, "Warning: ROM size (%u bytes) exceeds the %d bytes visible without a memory bank controller.\n", interconnect->rom_size, ROM_WINDOW);
+		}
+		mbc->ram_enabled = 1;  // Plain cartridge RAM needs no enable
+	}
+
+	mbc->bank_low = 0;
+	mbc->bank_high = 1;
+	mbc->rom_select = 1;
+	mbc->rtc_synced_at = interconnect->scheduler.now;
+	mbc_update(interconnect);
+}
+
+// Writable bits of each clock register
+static const uint8_t rtc_masks[RTC_REGISTERS] = {0x3F, 0x3F, 0x1F, 0xFF, 0xC1};
+
+// Advances the clock by one second. Registers written out of range keep counting
+// up to their bit width and wrap to 0 without carrying.
+static void mbc_rtc_tick(Mbc* mbc){
+	uint8_t* rtc = mbc->rtc;
+
+	rtc[RTC_SECONDS] = (rtc[RTC_SECONDS] + 1) & 0x3F;
+	if (rtc[RTC_SECONDS] != 60){
+		return;
+	}
+	rtc[RTC_SECONDS] = 0;
+	rtc[RTC_MINUTES] = (rtc[RTC_MINUTES] + 1) & 0x3F;
+	if (rtc[RTC_MINUTES] != 60){
+		return;
+	}
+	rtc[RTC_MINUTES] = 0;
+	rtc[RTC_HOURS] = (rtc[RTC_HOURS] + 1) & 0x1F;
+	if (rtc[RTC_HOURS] != 24){
+		return;
+	}
+	rtc[RTC_HOURS] = 0;
+
+	uint16_t day = (rtc[RTC_DAY_LOW] | ((rtc[RTC_DAY_HIGH] & 0x01) << 8)) + 1;
+	if (day > 0x1FF){
+		day = 0;
+		rtc[RTC_DAY_HIGH] |= RTC_CARRY;
+	}
+	rtc[RTC_DAY_LOW] = day & 0xFF;
+	rtc[RTC_DAY_HIGH] = (rtc[RTC_DAY_HIGH] & 0xFE) | (day >> 8);
+}
+
+// Counts the whole seconds elapsed since the last sync into the clock registers
+static void mbc_rtc_sync(Interconnect* interconnect){
+	Mbc* mbc = &interconnect->mbc;
+	uint8_t* rtc = mbc->rtc;
+	uint64_t now = interconnect->scheduler.now;
+
+	if (rtc[RTC_DAY_HIGH] & RTC_HALT){
+		mbc->rtc_synced_at = now;
+		return;
+	}
+
+	uint64_t seconds = (now - mbc->rtc_synced_at) / CYCLES_PER_SECOND;
+	mbc->rtc_synced_at += seconds * CYCLES_PER_SECOND;
+
+	// Step through out of range values, then add the rest in one go
+	while (seconds > 0 && (rtc[RTC_SECONDS] >= 60 || rtc[RTC_MINUTES] >= 60 || rtc[RTC_HOURS] >= 24)){
+		mbc_rtc_tick(mbc);
+		seconds--;
+	}
+	if (seconds == 0){
+		return;
+	}
+
+	uint64_t day = rtc[RTC_DAY_LOW] | ((rtc[RTC_DAY_HIGH] & 0x01) << 8);
+	uint64_t total = rtc[RTC_SECONDS] + 60 * (rtc[RTC_MINUTES] + 60 * (rtc[RTC_HOURS] + 24 * day)) + seconds;
+	day = total / 86400;
+	if (day > 0x1FF){
+		rtc[RTC_DAY_HIGH] |= RTC_CARRY;
+		day &= 0x1FF;
+	}
+	rtc[RTC_SECONDS] = total % 60;
+	rtc[RTC_MINUTES] = (total / 60) % 60;
+	rtc[RTC_HOURS] = (total / 3600) % 24;
+	rtc[RTC_DAY_LOW] = day & 0xFF;
+	rtc[RTC_DAY_HIGH] = (rtc[RTC_DAY_HIGH] & 0xFE) | (uint8_t)(day >> 8);
+}
+
+void mbc_write(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	Mbc* mbc = &interconnect->mbc;
+	uint8_t was_enabled = mbc->ram_enabled;
+
+	switch (mbc->type){
+		case MBC_1:
+			if (addr < 0x2000){
+				mbc->ram_enabled = (value & 0x0F) == 0x0A;
+			} else if (addr < 0x4000){
+				mbc->rom_select = value & 0x1F;
+			} else if (addr < 0x6000){
+				mbc->ram_select = value & 0x03;
+			} else {
+				mbc->mode = value & 0x01;
+			}
+			break;
+		case MBC_3:
+			if (addr < 0x2000){
+				mbc->ram_enabled = (value & 0x0F) == 0x0A;
+			} else if (addr < 0x4000){
+				mbc->rom_select = value & 0x7F;
+			} else if (addr < 0x6000){
+				mbc->ram_select = value;
+			} else {
+				// Writing 0 then 1 copies the running clock to the readable registers
+				if (mbc->has_rtc && mbc->rtc_latch == 0x00 && value == 0x01){
+					mbc_rtc_sync(interconnect);
+					for (int i = 0; i < RTC_REGISTERS; i++){
+						mbc->rtc_latched[i] = mbc->rtc[i];
+					}
+				}
+				mbc->rtc_latch = value;
+				return;  // Nothing mapped changes
+			}
+			break;
+		case MBC_5:
+			if (addr < 0x2000){
+				mbc->ram_enabled = (value & 0x0F) == 0x0A;
+			} else if (addr < 0x3000){
+				mbc->rom_select = (mbc->rom_select & 0x100) | value;
+			} else if (addr < 0x4000){
+				mbc->rom_select = (mbc->rom_select & 0xFF) | ((value & 0x01) << 8);
+			} else if (addr < 0x6000){
+				mbc->ram_select = value & 0x0F;
+			} else {
+				return;
+			}
+			break;
+		default:
+			return;  // Plain ROM ignores writes
+	}
+
+	// Games disable the RAM when they are done saving, flush the save file then
+	if (was_enabled && !mbc->ram_enabled){
+		flush_cartridge_ram(interconnect);
+	} else if (!was_enabled && mbc->ram_enabled){
+		mark_cartridge_ram_dirty(interconnect);
+	}
+	mbc_update(interconnect);
+}
+
+uint32_t mbc_rom_offset(const Interconnect* interconnect, uint16_t addr){
+	uint16_t bank = addr < ROM_BANK_SIZE ? interconnect->mbc.bank_low : interconnect->mbc.bank_high;
+	return bank * ROM_BANK_SIZE + (addr & (ROM_BANK_SIZE - 1));
+}
+
+uint8_t* mbc_eram_page(Interconnect* interconnect, uint8_t page){
+	Mbc* mbc = &interconnect->mbc;
+	if (!mbc->ram_enabled || mbc_rtc_selected(mbc)){
+		return NULL;
+	}
+
+	uint32_t offset = mbc->ram_bank * ERAM_BANK_SIZE + (page - 0xA0) * PAGE_SIZE;
+	if (offset + PAGE_SIZE > interconnect->eram_size){
+		return NULL;
+	}
+	return &interconnect->eram[offset];
+}
+
+uint8_t mbc_read_eram(Interconnect* interconnect, uint16_t addr){
+	Mbc* mbc = &interconnect->mbc;
+	if (mbc->ram_enabled && mbc_rtc_selected(mbc)){
+		return mbc->rtc_latched[mbc->ram_select - RTC_SELECT_FIRST];
+	}
+	return 0xFF;  // Disabled or missing RAM
+}
+
+void mbc_write_eram(Interconnect* interconnect, uint16_t addr, uint8_t value){
+	Mbc* mbc = &interconnect->mbc;
+	if (mbc->ram_enabled && mbc_rtc_selected(mbc)){
+		mbc_rtc_sync(interconnect);
+		uint8_t reg = mbc->ram_select - RTC_SELECT_FIRST;
+		mbc->rtc[reg] = value & rtc_masks[reg];
+		if (reg == RTC_SECONDS){
+			// Writing the seconds restarts the current second
+			mbc->rtc_synced_at = interconnect->scheduler.now;
+		}
+		return;
+	}
+
+	// Pages of enabled RAM that are off the write map hold cached code
+	uint8_t* page = mbc_eram_page(interconnect, addr >> 8);
+	if (page){
+		page[addr & 0xFF] = value;
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef MBC_H
+#define MBC_H
+
+#include <stdint.h>
+
+// Memory bank controllers, detected from cartridge header byte 0x147
+#define MBC_NONE 0
+#define MBC_1    1
+#define MBC_3    3
+#define MBC_5    5
+
+#define ROM_BANK_SIZE 0x4000
+#define ERAM_BANK_SIZE 0x2000
+
+// MBC3 real time clock registers, selected by writing 0x08-0x0C to 0x4000-0x5FFF
+#define RTC_SECONDS  0
+#define RTC_MINUTES  1
+#define RTC_HOURS    2
+#define RTC_DAY_LOW  3
+#define RTC_DAY_HIGH 4  // Bit 0: day bit 8, bit 6: halt, bit 7: day counter carry
+#define RTC_REGISTERS 5
+#define RTC_SELECT_FIRST 0x08
+
+#define RTC_HALT  0x40
+#define RTC_CARRY 0x80
+#define CYCLES_PER_SECOND 4194304  // T-cycles, the clock follows emulated time
+
+// Controller state, part of Interconnect so snapshots include it. The bank
+// registers only change the pages of the memory map they affect, reads and
+// writes through mapped banks never look at this.
+typedef struct Mbc_t {
+	uint8_t type;           // MBC_*
+	uint8_t has_rtc;
+	uint8_t has_battery;    // RAM persists in a save file, see attach_save_file()
+	uint16_t rom_banks;     // Number of 16K banks in the image
+
+	// Registers as written by the game
+	uint8_t ram_enabled;
+	uint8_t mode;           // MBC1 banking mode
+	uint16_t rom_select;    // MBC1: 5 bits, MBC3: 7 bits, MBC5: 9 bits
+	uint8_t ram_select;     // RAM bank, MBC1 upper ROM bits, or RTC register
+
+	// Banks currently mapped, derived from the registers by mbc_update()
+	uint16_t bank_low;      // ROM bank at 0x0000-0x3FFF
+	uint16_t bank_high;     // ROM bank at 0x4000-0x7FFF
+	uint8_t ram_bank;       // Cartridge RAM bank at 0xA000-0xBFFF
+
+	// MBC3 real time clock, advanced lazily from the scheduler timestamp
+	uint8_t rtc[RTC_REGISTERS];
+	uint8_t rtc_latched[RTC_REGISTERS];  // What reads return, see mbc_write()
+	uint8_t rtc_latch;                   // Last write to 0x6000-0x7FFF
+	uint64_t rtc_synced_at;              // Timestamp of the last whole second counted
+} Mbc;
+
+struct Interconnect_t;
+
+// Detects the controller from the header of the loaded ROM and maps its banks
+void mbc_initialize(struct Interconnect_t* interconnect);
+
+// Writes to the controller registers (0x0000-0x7FFF)
+void mbc_write(struct Interconnect_t* interconnect, uint16_t addr, uint8_t value);
+
+// Offset in the ROM image of an address in 0x0000-0x7FFF
+uint32_t mbc_rom_offset(const struct Interconnect_t* interconnect, uint16_t addr);
+
+// Host page of cartridge RAM for a page in 0xA0-0xBF, NULL when disabled,
+// showing a clock register or past the end of the RAM
+uint8_t* mbc_eram_page(struct Interconnect_t* interconnect, uint8_t page);
+
+// Accesses to 0xA000-0xBFFF that have no host page
+uint8_t mbc_read_eram(struct Interconnect_t* interconnect, uint16_t addr);
+void mbc_write_eram(struct Interconnect_t* interconnect, uint16_t addr, uint8_t value);
+
+#endif /* MBC_H */
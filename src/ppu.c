@@ -1,34 +1,118 @@
 #include "ppu.h"
+#include "ppu_pixels.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-void initialize_ppu(PPU** ppu){
-	*ppu = (PPU*) malloc(sizeof(PPU));
-	memset(*ppu, 0, sizeof(PPU));
+void initialize_ppu(PPU* ppu){
+	memset(ppu, 0, sizeof(PPU));
 
 	// Initialize registers to Game Boy boot values
-	(*ppu)->lcdc = 0x91;  // LCD on, BG on, tile data at 8000-8FFF
-	(*ppu)->stat = 0x00;
-	(*ppu)->scy = 0x00;
-	(*ppu)->scx = 0x00;
-	(*ppu)->ly = 0x00;
-	(*ppu)->lyc = 0x00;
-	(*ppu)->bgp = 0xFC;   // Default palette: 11 11 10 00
-	(*ppu)->obp0 = 0xFF;
-	(*ppu)->obp1 = 0xFF;
-	(*ppu)->wy = 0x00;
-	(*ppu)->wx = 0x00;
-
-	(*ppu)->cycles = 0;
-	(*ppu)->mode = MODE_OAM;
-	(*ppu)->frame_ready = 0;
-	(*ppu)->vblank_interrupt_requested = 0;
+	ppu->lcdc = 0x91;  // LCD on, BG on, tile data at 8000-8FFF
+	ppu->stat = 0x00;
+	ppu->scy = 0x00;
+	ppu->scx = 0x00;
+	ppu->ly = 0x00;
+	ppu->lyc = 0x00;
+	ppu->bgp = 0xFC;   // Default palette: 11 11 10 00
+	ppu->obp0 = 0xFF;
+	ppu->obp1 = 0xFF;
+	ppu->wy = 0x00;
+	ppu->wx = 0x00;
+
+	ppu->cycles = 0;
+	ppu->mode = MODE_OAM;
+	ppu->frame_ready = 0;
+	ppu->vblank_interrupt_requested = 0;
+	ppu->sprite_lines_stale = 1;
 
 	// Initialize framebuffer to white
-	memset((*ppu)->framebuffer, COLOR_WHITE, sizeof((*ppu)->framebuffer));
+	memset(ppu->framebuffer, COLOR_WHITE * 0x55, sizeof(ppu->framebuffer));
+
+	ppu_pixels_init();
+	ppu->tile_cache = (TileCache*) calloc(1, sizeof(TileCache));
+	ppu->map_cache = (MapCache*) calloc(1, sizeof(MapCache));
+	ppu_flush_caches(ppu);
+}
+
+// Rows of decoded pixels follow the bitplane byte pairs they come from, 2 bytes
+// of tile data to 8 pixels
+static inline uint8_t* decoded_row(PPU* ppu, uint16_t offset){
+	return &ppu->tile_cache->pixels[0][0] + offset / 2 * 8;
+}
+
+// Tile index in the cache: tiles 0-255 start at 0x8000, signed tile numbers
+// (-128 to 127) count from tile 256 at 0x9000
+static inline uint16_t tile_index(uint8_t tile_num, int mode){
+	return mode == TILE_MODE_SIGNED ? 256 + (int8_t)tile_num : tile_num;
+}
+
+// Moves a map entry from the users of the tiles it showed to those of tile_num,
+// and marks its cells stale in both images of its map
+static void map_entry_changed(MapCache* cache, uint32_t cell, uint8_t tile_num){
+	uint64_t bit = 1ULL << (cell % 64);
+	for (int mode = 0; mode < TILE_MODES; mode++){
+		cache->users[tile_index(cache->entries[cell], mode)][cell / 64] &= ~bit;
+	}
+	cache->entries[cell] = tile_num;
+	for (int mode = 0; mode < TILE_MODES; mode++){
+		cache->users[tile_index(tile_num, mode)][cell / 64] |= bit;
+		cache->dirty[mode][cell / 64] |= bit;
+	}
+}
+
+void ppu_vram_written(PPU* ppu, uint16_t offset, uint32_t count){
+	MapCache* map_cache = ppu->map_cache;
+	uint32_t end = offset + count;
+
+	// Tile data: decode now, let the map images catch up when a line needs them
+	uint32_t tile_end = end < TILE_DATA_SIZE ? end : TILE_DATA_SIZE;
+	uint16_t first = offset & ~1;
+	if (first < tile_end){
+		ppu_decode_rows(&ppu->vram[first], decoded_row(ppu, first), (tile_end - first + 1) / 2);
+		for (uint32_t tile = first / TILE_BYTES; tile <= (tile_end - 1) / TILE_BYTES; tile++){
+			map_cache->tiles_changed[tile / 64] |= 1ULL << (tile % 64);
+		}
+	}
+
+	// Tile maps, compared against the entries the cache follows
+	for (uint32_t map_offset = offset > TILE_DATA_SIZE ? offset : TILE_DATA_SIZE; map_offset < end; map_offset++){
+		uint32_t cell = map_offset - TILE_DATA_SIZE;
+		if (map_cache->entries[cell] != ppu->vram[map_offset]){
+			map_entry_changed(map_cache, cell, ppu->vram[map_offset]);
+		}
+	}
+}
+
+void ppu_flush_caches(PPU* ppu){
+	MapCache* map_cache = ppu->map_cache;
+
+	// Every entry stale and following its current tile number
+	memset(map_cache->users, 0, sizeof(map_cache->users));
+	for (uint32_t cell = 0; cell < MAP_CELLS; cell++){
+		map_cache->entries[cell] = ppu->vram[TILE_DATA_SIZE + cell];
+		for (int mode = 0; mode < TILE_MODES; mode++){
+			map_cache->users[tile_index(map_cache->entries[cell], mode)][cell / 64] |= 1ULL << (cell % 64);
+		}
+	}
+	memset(map_cache->dirty, 0xFF, sizeof(map_cache->dirty));
+	memset(map_cache->tiles_changed, 0, sizeof(map_cache->tiles_changed));
+
+	ppu_decode_rows(ppu->vram, decoded_row(ppu, 0), TILE_DATA_SIZE / 2);
+	ppu->sprite_lines_stale = 1;
+}
+
+// Length in T-cycles of the given mode (one scanline per step in V-Blank)
+static uint32_t mode_duration(uint8_t mode){
+	switch(mode){
+		case MODE_OAM:    return 80;
+		case MODE_XFER:   return 172;
+		case MODE_HBLANK: return 204;
+		default:          return CYCLES_PER_SCANLINE;
+	}
 }
 
+// Advances the PPU by any number of T-cycles, performing every mode transition in between
 void ppu_step(PPU* ppu, uint32_t cycles){
 	if (!(ppu->lcdc & LCDC_LCD_ENABLE)){
 		// LCD is off
@@ -37,34 +121,29 @@ void ppu_step(PPU* ppu, uint32_t cycles){
 
 	ppu->cycles += cycles;
 
-	switch(ppu->mode){
-		case MODE_OAM:  // OAM Search - 80 cycles
-			if (ppu->cycles >= 80){
-				ppu->cycles -= 80;
+	while (ppu->cycles >= mode_duration(ppu->mode)){
+		ppu->cycles -= mode_duration(ppu->mode);
+
+		switch(ppu->mode){
+			case MODE_OAM:  // OAM Search - 80 cycles
 				ppu->mode = MODE_XFER;
 				ppu->stat = (ppu->stat & ~STAT_MODE_MASK) | MODE_XFER;
-			}
-			break;
+				break;
 
-		case MODE_XFER:  // Pixel Transfer - 172 cycles
-			if (ppu->cycles >= 172){
-				ppu->cycles -= 172;
+			case MODE_XFER:  // Pixel Transfer - 172 cycles
 				ppu->mode = MODE_HBLANK;
 				ppu->stat = (ppu->stat & ~STAT_MODE_MASK) | MODE_HBLANK;
 
 				// Render current scanline
 				ppu_render_scanline(ppu);
-			}
-			break;
+				break;
 
-		case MODE_HBLANK:  // H-Blank - 204 cycles
-			if (ppu->cycles >= 204){
-				ppu->cycles -= 204;
+			case MODE_HBLANK:  // H-Blank - 204 cycles
 				ppu->ly++;
 
 				if (ppu->ly >= VBLANK_START){
 					// Enter V-Blank
-												ppu->mode = MODE_VBLANK;
+					ppu->mode = MODE_VBLANK;
 					ppu->stat = (ppu->stat & ~STAT_MODE_MASK) | MODE_VBLANK;
 					ppu->frame_ready = 1;  // Frame is complete
 					ppu->vblank_interrupt_requested = 1;  // Request V-Blank interrupt
@@ -80,77 +159,84 @@ void ppu_step(PPU* ppu, uint32_t cycles){
 				} else {
 					ppu->stat &= ~STAT_LYC_EQUAL;
 				}
-			}
-			break;
+				break;
 
-		case MODE_VBLANK:  // V-Blank - 4560 cycles (10 scanlines)
-			if (ppu->cycles >= CYCLES_PER_SCANLINE){
-				ppu->cycles -= CYCLES_PER_SCANLINE;
+			case MODE_VBLANK:  // V-Blank - 4560 cycles (10 scanlines)
 				ppu->ly++;
 
 				if (ppu->ly >= SCANLINES_PER_FRAME){
 					// Frame complete, reset to scanline 0
 					ppu->ly = 0;
+					ppu->window_line = 0;
 					ppu->mode = MODE_OAM;
 					ppu->stat = (ppu->stat & ~STAT_MODE_MASK) | MODE_OAM;
 				}
-			}
-			break;
+				break;
+		}
 	}
 }
 
-void ppu_render_sprites(PPU* ppu, uint8_t scanline){
-	// Check if sprites are enabled
-	if (!(ppu->lcdc & LCDC_OBJ_ENABLE)){
-		return;
+// T-cycles until the next mode transition, or 0 if the LCD is off and nothing will happen
+uint32_t ppu_cycles_to_next_mode(PPU* ppu){
+	if (!(ppu->lcdc & LCDC_LCD_ENABLE)){
+		return 0;
 	}
+	return mode_duration(ppu->mode) - ppu->cycles;
+}
 
-	// Determine sprite height (8x8 or 8x16)
-	uint8_t sprite_height = (ppu->lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
-
-	// Find sprites that intersect with this scanline
-	// OAM has 40 sprites, each is 4 bytes
+// Sorts every sprite into the lists of the lines it covers. Each line takes the
+// first 10 sprites in OAM order that cover it, like OAM search does. They are
+// kept in drawing priority order: lower X first, and lower OAM index first
+// among equal X. Sprites arrive in OAM order, so inserting each one after every
+// sprite with the same or a lower X keeps that order.
+static void build_sprite_lines(PPU* ppu){
 	Sprite* sprites = (Sprite*)ppu->oam;
-	int sprite_count = 0;
-	int sprite_indices[MAX_SPRITES_PER_LINE];
+	int sprite_height = (ppu->lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
+	memset(ppu->sprite_line_counts, 0, sizeof(ppu->sprite_line_counts));
 
-	// Scan through all sprites in OAM
 	for (int i = 0; i < SPRITES_IN_OAM; i++){
-		Sprite* sprite = &sprites[i];
-
 		// Sprite Y is offset by 16
-		int sprite_y = sprite->y - 16;
-
-		// Check if sprite intersects with current scanline
-		if (scanline >= sprite_y && scanline < sprite_y + sprite_height){
-			sprite_indices[sprite_count] = i;
-			sprite_count++;
+		int first_line = sprites[i].y - 16;
+		int last_line = first_line + sprite_height - 1;
+		if (first_line < 0) first_line = 0;
+		if (last_line >= LCD_HEIGHT) last_line = LCD_HEIGHT - 1;
+
+		for (int line = first_line; line <= last_line; line++){
+			uint8_t* list = ppu->sprite_lines[line];
+			uint8_t count = ppu->sprite_line_counts[line];
+			if (count >= MAX_SPRITES_PER_LINE){
+				continue;  // Game Boy can only display 10 sprites per scanline
+			}
 
-			// Game Boy can only display 10 sprites per scanline
-			if (sprite_count >= MAX_SPRITES_PER_LINE){
-				break;
+			int position = count;
+			while (position > 0 && sprites[list[position - 1]].x > sprites[i].x){
+				list[position] = list[position - 1];
+				position--;
 			}
+			list[position] = i;
+			ppu->sprite_line_counts[line] = count + 1;
 		}
 	}
+	ppu->sprite_lines_stale = 0;
+}
 
-	// Sort sprites by X coordinate (lower X = higher priority)
-	// If X is equal, lower OAM index (earlier in list) = higher priority
-	for (int i = 0; i < sprite_count - 1; i++){
-		for (int j = i + 1; j < sprite_count; j++){
-			Sprite* sprite_i = &sprites[sprite_indices[i]];
-			Sprite* sprite_j = &sprites[sprite_indices[j]];
-
-			// Sort by X coordinate (ascending)
-			// If X equal, sort by OAM index (ascending, already in order)
-			if (sprite_j->x < sprite_i->x){
-				// Swap
-				int temp = sprite_indices[i];
-				sprite_indices[i] = sprite_indices[j];
-				sprite_indices[j] = temp;
-			}
-		}
+void ppu_render_sprites(PPU* ppu, uint8_t scanline){
+	// Check if sprites are enabled
+	if (!(ppu->lcdc & LCDC_OBJ_ENABLE)){
+		return;
 	}
 
+	// Determine sprite height (8x8 or 8x16)
+	uint8_t sprite_height = (ppu->lcdc & LCDC_OBJ_SIZE) ? 16 : 8;
+
+	// Sprites that intersect with this scanline, in priority order
+	if (ppu->sprite_lines_stale){
+		build_sprite_lines(ppu);
+	}
+	Sprite* sprites = (Sprite*)ppu->oam;
+	const uint8_t* sprite_indices = ppu->sprite_lines[scanline];
+	int sprite_count = ppu->sprite_line_counts[scanline];
+
 	// Track which pixels have been drawn by sprites (for priority between sprites)
 	uint8_t sprite_drawn[LCD_WIDTH] = {0};
 
@@ -187,14 +273,12 @@ void ppu_render_sprites(PPU* ppu, uint8_t scanline){
 			}
 		}
 
-		// Sprites always use 8000-8FFF addressing mode
-		uint16_t tile_addr = 0x8000 + (tile_num * 16);
-		uint16_t tile_line_addr = tile_addr + (sprite_line * 2);
-		uint8_t low_byte = ppu->vram[tile_line_addr - VRAM_START];
-		uint8_t high_byte = ppu->vram[tile_line_addr + 1 - VRAM_START];
+		// Sprites always use 8000-8FFF addressing mode, tiles 0-255
+		const uint8_t* pixels = &ppu->tile_cache->pixels[tile_num][sprite_line * 8];
 
-		// Select palette
-		uint8_t palette = palette_num ? ppu->obp1 : ppu->obp0;
+		// Colors of the whole row through the selected palette
+		uint8_t colors[8];
+		ppu_apply_palette(pixels, colors, 8, palette_num ? ppu->obp1 : ppu->obp0);
 
 		// Render 8 pixels of the sprite
 		for (int x = 0; x < 8; x++){
@@ -210,11 +294,9 @@ void ppu_render_sprites(PPU* ppu, uint8_t scanline){
 				continue;
 			}
 
-			// Calculate bit position (with x flip)
-			int bit_pos = x_flip ? x : (7 - x);
-
-			// Get color value (2 bits)
-			uint8_t color_num = ((high_byte >> bit_pos) & 1) << 1 | ((low_byte >> bit_pos) & 1);
+			// Get color value (2 bits, with x flip)
+			int tile_x = x_flip ? 7 - x : x;
+			uint8_t color_num = pixels[tile_x];
 
 			// Color 0 is transparent for sprites
 			if (color_num == 0){
@@ -224,17 +306,14 @@ void ppu_render_sprites(PPU* ppu, uint8_t scanline){
 			// Check priority vs background
 			if (priority){
 				// Sprite behind BG color indices 1-3 (but above BG color index 0)
-				uint8_t bg_color_index = ppu->bg_colors[scanline * LCD_WIDTH + screen_x];
+				uint8_t bg_color_index = ppu->bg_line[screen_x];
 				if (bg_color_index != 0){
 					continue;  // BG pixel is not color 0, sprite is behind
 				}
 			}
 
-			// Apply palette
-			uint8_t color = (palette >> (color_num * 2)) & 0x03;
-
-			// Write to framebuffer
-			ppu->framebuffer[scanline * LCD_WIDTH + screen_x] = color;
+			// Write to the scanline
+			ppu->line[screen_x] = colors[tile_x];
 
 			// Mark this pixel as drawn by a sprite
 			sprite_drawn[screen_x] = 1;
@@ -242,77 +321,105 @@ void ppu_render_sprites(PPU* ppu, uint8_t scanline){
 	}
 }
 
+// Marks the entries using changed tiles stale. Tiles 0-127 only show in unsigned
+// mode, 256-383 only in signed mode, 128-255 in both for the same tile number.
+static void propagate_tile_changes(MapCache* cache){
+	for (uint32_t word = 0; word < TILE_COUNT / 64; word++){
+		while (cache->tiles_changed[word] != 0){
+			uint32_t bit = __builtin_ctzll(cache->tiles_changed[word]);
+			cache->tiles_changed[word] &= cache->tiles_changed[word] - 1;
+
+			uint32_t tile = word * 64 + bit;
+			for (int mode = 0; mode < TILE_MODES; mode++){
+				if (mode == TILE_MODE_UNSIGNED ? tile >= 256 : tile < 128){
+					continue;
+				}
+				for (uint32_t users = 0; users < MAP_CELLS / 64; users++){
+					cache->dirty[mode][users] |= cache->users[tile][users];
+				}
+			}
+		}
+	}
+}
+
+// Line map_y of a tile map image in the current addressing mode, with the band
+// of 32 entries it crosses redrawn first if any of them is stale
+static const uint8_t* map_image_line(PPU* ppu, int map, uint8_t map_y){
+	MapCache* cache = ppu->map_cache;
+	int mode = (ppu->lcdc & LCDC_BG_WIN_TILEDATA) ? TILE_MODE_UNSIGNED : TILE_MODE_SIGNED;
+	uint8_t* image = cache->images[map][mode];
+	propagate_tile_changes(cache);
+
+	// A band is half of a dirty word
+	uint32_t first_cell = map * MAP_ENTRIES + (map_y / 8) * MAP_WIDTH;
+	uint64_t* dirty = &cache->dirty[mode][first_cell / 64];
+	uint64_t band = 0xFFFFFFFFULL << (first_cell % 64);
+	if (*dirty & band){
+		for (uint32_t tile_col = 0; tile_col < MAP_WIDTH; tile_col++){
+			if (!(*dirty & (1ULL << (first_cell % 64 + tile_col)))){
+				continue;
+			}
+			const uint8_t* pixels = ppu->tile_cache->pixels[tile_index(cache->entries[first_cell + tile_col], mode)];
+			uint8_t* cell = &image[(map_y / 8) * 8 * MAP_PIXELS + tile_col * 8];
+			for (int row = 0; row < 8; row++){
+				memcpy(&cell[row * MAP_PIXELS], &pixels[row * 8], 8);
+			}
+		}
+		*dirty &= ~band;
+	}
+	return &image[map_y * MAP_PIXELS];
+}
+
+// Copies the color indices of one tile map line into bg_line[x..end), starting at
+// map_x in the 256 pixel wide map and wrapping around it
+static void copy_map_line(PPU* ppu, int map, uint8_t map_x, uint8_t map_y, int x, int end){
+	if (x >= end){
+		return;
+	}
+	const uint8_t* line = map_image_line(ppu, map, map_y);
+	int count = end - x;
+	int before_wrap = MAP_PIXELS - map_x < count ? MAP_PIXELS - map_x : count;
+	memcpy(&ppu->bg_line[x], &line[map_x], before_wrap);
+	memcpy(&ppu->bg_line[x + before_wrap], line, count - before_wrap);
+}
+
 void ppu_render_scanline(PPU* ppu){
 	uint8_t ly = ppu->ly;
 	if (ly >= LCD_HEIGHT){
 		return;  // Don't render V-Blank lines
 	}
 
-	// Render background
+	// Render background and window color indices (kept for sprite priority)
 	if (!(ppu->lcdc & LCDC_BG_WIN_ENABLE)){
-		// BG disabled, fill with white
-		for (int x = 0; x < LCD_WIDTH; x++){
-			ppu->framebuffer[ly * LCD_WIDTH + x] = COLOR_WHITE;
-			ppu->bg_colors[ly * LCD_WIDTH + x] = 0;  // BG color index 0
-		}
+		// BG and window disabled, BG color index 0 shows as white
+		memset(ppu->bg_line, 0, LCD_WIDTH);
+		memset(ppu->line, COLOR_WHITE, LCD_WIDTH);
 	} else {
-		// Determine tile map base address
-		uint16_t tilemap_base = (ppu->lcdc & LCDC_BG_TILEMAP) ? 0x9C00 : 0x9800;
-
-		// Determine tile data base address
-		int signed_tile_nums = !(ppu->lcdc & LCDC_BG_WIN_TILEDATA);
-		uint16_t tiledata_base = signed_tile_nums ? 0x9000 : 0x8000;
-
-		// Calculate Y position in background map (with scroll)
-		uint8_t bg_y = (ly + ppu->scy) & 0xFF;
-		uint8_t tile_row = bg_y / 8;
-		uint8_t tile_y_offset = bg_y % 8;
-
-		// Render each pixel in the scanline
-		for (int x = 0; x < LCD_WIDTH; x++){
-			// Calculate X position in background map (with scroll)
-			uint8_t bg_x = (x + ppu->scx) & 0xFF;
-			uint8_t tile_col = bg_x / 8;
-			uint8_t tile_x_offset = bg_x % 8;
-
-			// Get tile number from tile map
-			uint16_t tilemap_addr = tilemap_base + (tile_row * 32) + tile_col;
-			uint8_t tile_num = ppu->vram[tilemap_addr - VRAM_START];
-
-			// Calculate tile data address
-			uint16_t tile_addr;
-			if (signed_tile_nums){
-				// Signed tile numbers (-128 to 127)
-				int8_t signed_tile = (int8_t)tile_num;
-				tile_addr = tiledata_base + (signed_tile * 16);
-			} else {
-				// Unsigned tile numbers (0 to 255)
-				tile_addr = tiledata_base + (tile_num * 16);
-			}
-
-			// Each tile is 16 bytes (8x8 pixels, 2 bits per pixel)
-			// Each row is 2 bytes (low bit and high bit)
-			uint16_t tile_line_addr = tile_addr + (tile_y_offset * 2);
-			uint8_t low_byte = ppu->vram[tile_line_addr - VRAM_START];
-			uint8_t high_byte = ppu->vram[tile_line_addr + 1 - VRAM_START];
-
-			// Get color value (2 bits)
-			int bit_pos = 7 - tile_x_offset;
-			uint8_t color_num = ((high_byte >> bit_pos) & 1) << 1 | ((low_byte >> bit_pos) & 1);
-
-			// Store original BG color index (for sprite priority)
-			ppu->bg_colors[ly * LCD_WIDTH + x] = color_num;
-
-			// Apply palette
-			uint8_t color = (ppu->bgp >> (color_num * 2)) & 0x03;
+		int bg_map = (ppu->lcdc & LCDC_BG_TILEMAP) ? 1 : 0;
+		int window_map = (ppu->lcdc & LCDC_WIN_TILEMAP) ? 1 : 0;
+
+		// The window covers the line from WX - 7 on, once LY has reached WY. It has
+		// its own line counter, which only advances on lines that show it.
+		int window_x = LCD_WIDTH;
+		if ((ppu->lcdc & LCDC_WIN_ENABLE) && ly >= ppu->wy && ppu->wx < LCD_WIDTH + 7){
+			window_x = ppu->wx < 7 ? 0 : ppu->wx - 7;
+		}
 
-			// Write to framebuffer
-			ppu->framebuffer[ly * LCD_WIDTH + x] = color;
+		copy_map_line(ppu, bg_map, ppu->scx, ly + ppu->scy, 0, window_x);
+		if (window_x < LCD_WIDTH){
+			copy_map_line(ppu, window_map, window_x + 7 - ppu->wx, ppu->window_line, window_x, LCD_WIDTH);
+			ppu->window_line++;
 		}
+
+		// Apply palette
+		ppu_apply_palette(ppu->bg_line, ppu->line, LCD_WIDTH, ppu->bgp);
 	}
 
 	// Render sprites on top of background
 	ppu_render_sprites(ppu, ly);
+
+	// Pack the finished scanline into the framebuffer
+	ppu_pack_pixels(ppu->line, &ppu->framebuffer[ly * LCD_WIDTH / PIXELS_PER_BYTE], LCD_WIDTH);
 }
 
 // Register read/write
@@ -337,10 +444,14 @@ uint8_t ppu_read_register(PPU* ppu, uint16_t addr){
 void ppu_write_register(PPU* ppu, uint16_t addr, uint8_t value){
 	switch(addr){
 		case 0xFF40:
+			if ((ppu->lcdc ^ value) & LCDC_OBJ_SIZE){
+				ppu->sprite_lines_stale = 1;
+			}
 			ppu->lcdc = value;
 			if (!(value & LCDC_LCD_ENABLE)){
 				// LCD turned off, reset state
 				ppu->ly = 0;
+				ppu->window_line = 0;
 				ppu->mode = MODE_OAM;
 				ppu->cycles = 0;
 			}
@@ -353,7 +464,7 @@ void ppu_write_register(PPU* ppu, uint16_t addr, uint8_t value){
 		case 0xFF43: ppu->scx = value; break;
 		case 0xFF44: /* LY is read-only */ break;
 		case 0xFF45: ppu->lyc = value; break;
-		case 0xFF46: ppu->dma = value; break;  // DMA handled elsewhere
+		case 0xFF46: ppu->dma = value; break;  // Transfer started by the interconnect, see start_oam_dma()
 		case 0xFF47: ppu->bgp = value; break;
 		case 0xFF48: ppu->obp0 = value; break;
 		case 0xFF49: ppu->obp1 = value; break;
@@ -372,7 +483,9 @@ uint8_t ppu_read_vram(PPU* ppu, uint16_t addr){
 
 void ppu_write_vram(PPU* ppu, uint16_t addr, uint8_t value){
 	if (addr >= VRAM_START && addr <= VRAM_END){
-		ppu->vram[addr - VRAM_START] = value;
+		uint16_t offset = addr - VRAM_START;
+		ppu->vram[offset] = value;
+		ppu_vram_written(ppu, offset, 1);
 	}
 }
 
@@ -386,6 +499,15 @@ uint8_t ppu_read_oam(PPU* ppu, uint16_t addr){
 
 void ppu_write_oam(PPU* ppu, uint16_t addr, uint8_t value){
 	if (addr >= OAM_START && addr <= OAM_END){
-		ppu->oam[addr - OAM_START] = value;
+		uint8_t offset = addr - OAM_START;
+		// Tile and attributes are read when drawing, only positions affect the lists
+		if (offset % sizeof(Sprite) < 2 && ppu->oam[offset] != value){
+			ppu->sprite_lines_stale = 1;
+		}
+		ppu->oam[offset] = value;
 	}
 }
+
+void ppu_oam_written(PPU* ppu){
+	ppu->sprite_lines_stale = 1;
+}
@@ -15,6 +15,28 @@
 #define OAM_START 0xFE00
 #define OAM_END 0xFE9F
 
+// Tile data (0x8000-0x97FF): 384 tiles of 8x8 pixels, 16 bytes each
+#define TILE_COUNT 384
+#define TILE_BYTES 16
+#define TILE_PIXELS 64
+#define TILE_DATA_SIZE (TILE_COUNT * TILE_BYTES)
+
+// Tile maps (0x9800-0x9BFF and 0x9C00-0x9FFF): 32x32 tile numbers each, 256x256 pixels
+#define MAP_COUNT 2
+#define MAP_WIDTH 32
+#define MAP_ENTRIES (MAP_WIDTH * MAP_WIDTH)
+#define MAP_PIXELS 256
+#define MAP_CELLS (MAP_COUNT * MAP_ENTRIES)  // Entries of both maps, map 0x9800 first
+
+// Tile data addressing modes, selected by LCDC_BG_WIN_TILEDATA
+#define TILE_MODE_UNSIGNED 0  // 8000-8FFF, tiles 0-255
+#define TILE_MODE_SIGNED   1  // 8800-97FF, tile 256 at 0x9000
+#define TILE_MODES 2
+
+// Framebuffer packing: 2 bits per pixel, 4 pixels per byte, leftmost in the low bits
+#define PIXELS_PER_BYTE 4
+#define FRAMEBUFFER_SIZE (LCD_WIDTH * LCD_HEIGHT / PIXELS_PER_BYTE)
+
 // LCD Control Register (LCDC) bits - 0xFF40
 #define LCDC_BG_WIN_ENABLE    0x01  // Bit 0: BG and Window enable
 #define LCDC_OBJ_ENABLE       0x02  // Bit 1: OBJ enable
@@ -68,17 +90,33 @@ typedef struct Sprite_t {
 	uint8_t attributes; // Attributes/flags
 } Sprite;
 
+// Tile data decoded to one color index (0-3) per pixel, rows of 8 left to right.
+// Kept in step with VRAM by ppu_write_vram() and ppu_vram_written(), so renderers
+// copy rows instead of pulling bits out of the bitplanes. Derived data, it lives
+// outside the machine block like the CPU's block cache.
+typedef struct TileCache_t {
+	uint8_t pixels[TILE_COUNT][TILE_PIXELS];
+} TileCache;
+
+// Both tile maps rendered to color indices in both addressing modes, so a
+// background or window line is a copy out of one of the four images. Entries are
+// redrawn lazily, a band of 32 at a time right before a line reads it:
+//  - A map write marks its entry dirty in both modes and moves it between the
+//    users bitmaps of the tiles it showed and now shows
+//  - A tile data write only sets the tile in tiles_changed. Before the next line,
+//    every entry using a changed tile is marked dirty in the modes where it
+//    shows that tile.
+// Like the tile cache, this is derived data outside the machine block.
+typedef struct MapCache_t {
+	uint8_t images[MAP_COUNT][TILE_MODES][MAP_PIXELS * MAP_PIXELS];
+	uint64_t users[TILE_COUNT][MAP_CELLS / 64];  // Entries showing each tile, in either mode
+	uint64_t dirty[TILE_MODES][MAP_CELLS / 64];  // Entries whose image cell is stale
+	uint64_t tiles_changed[TILE_COUNT / 64];
+	uint8_t entries[MAP_CELLS];                  // Tile numbers the users bitmaps follow
+} MapCache;
+
+// Registers and counters first, they are read on every PPU sync
 typedef struct PPU_t {
-	// Video RAM
-	uint8_t vram[VRAM_SIZE];
-	uint8_t oam[OAM_SIZE];
-
-	// Framebuffer (160x144, 2 bits per pixel = 4 colors)
-	uint8_t framebuffer[LCD_WIDTH * LCD_HEIGHT];
-
-	// BG color indices (before palette mapping, needed for sprite priority)
-	uint8_t bg_colors[LCD_WIDTH * LCD_HEIGHT];
-
 	// LCD Registers
 	uint8_t lcdc;      // 0xFF40 - LCD Control
 	uint8_t stat;      // 0xFF41 - LCD Status
@@ -96,16 +134,48 @@ typedef struct PPU_t {
 	// Internal state
 	uint32_t cycles;       // Cycle counter for current scanline
 	uint8_t mode;          // Current PPU mode
+	uint8_t window_line;   // Window line shown next, counts only lines showing the window
 	int frame_ready;       // Flag: new frame is ready to display
 	int vblank_interrupt_requested;  // Flag: V-Blank interrupt requested
+	TileCache* tile_cache;           // Per instance, see ppu_flush_caches()
+	MapCache* map_cache;
+
+	// Video RAM
+	uint8_t vram[VRAM_SIZE];
+	uint8_t oam[OAM_SIZE];
+
+	// Framebuffer (160x144, 2 bits per pixel = 4 colors), packed, see ppu_pixel()
+	uint8_t framebuffer[FRAMEBUFFER_SIZE];
+
+	// Scanline being rendered, packed into the framebuffer once complete
+	uint8_t line[LCD_WIDTH];
+	// BG color indices of that scanline (before palette mapping, needed for sprite priority)
+	uint8_t bg_line[LCD_WIDTH];
+
+	// OAM indices of the sprites on each visible line, in drawing priority order.
+	// Rebuilt before the next line once OAM positions or the sprite height change.
+	uint8_t sprite_lines[LCD_HEIGHT][MAX_SPRITES_PER_LINE];
+	uint8_t sprite_line_counts[LCD_HEIGHT];
+	uint8_t sprite_lines_stale;
 } PPU;
 
 // PPU Functions
-void initialize_ppu(PPU** ppu);
+void initialize_ppu(PPU* ppu);
 void ppu_step(PPU* ppu, uint32_t cycles);
+uint32_t ppu_cycles_to_next_mode(PPU* ppu);
 void ppu_render_scanline(PPU* ppu);
 void ppu_render_sprites(PPU* ppu, uint8_t scanline);
 
+// Rebuilds everything the PPU derives from VRAM and OAM. Needed when they change without
+// going through the write path, like when a snapshot is loaded.
+void ppu_flush_caches(PPU* ppu);
+
+// Color of a framebuffer pixel (0-3)
+static inline uint8_t ppu_pixel(const PPU* ppu, int x, int y){
+	int index = y * LCD_WIDTH + x;
+	return (ppu->framebuffer[index / PIXELS_PER_BYTE] >> ((index % PIXELS_PER_BYTE) * 2)) & 0x03;
+}
+
 // Register access
 uint8_t ppu_read_register(PPU* ppu, uint16_t addr);
 void ppu_write_register(PPU* ppu, uint16_t addr, uint8_t value);
@@ -113,7 +183,11 @@ void ppu_write_register(PPU* ppu, uint16_t addr, uint8_t value);
 // Memory access
 uint8_t ppu_read_vram(PPU* ppu, uint16_t addr);
 void ppu_write_vram(PPU* ppu, uint16_t addr, uint8_t value);
+// VRAM bytes at offset (from 0x8000) were written directly, not through ppu_write_vram()
+void ppu_vram_written(PPU* ppu, uint16_t offset, uint32_t count);
 uint8_t ppu_read_oam(PPU* ppu, uint16_t addr);
 void ppu_write_oam(PPU* ppu, uint16_t addr, uint8_t value);
+// OAM was written directly, not through ppu_write_oam()
+void ppu_oam_written(PPU* ppu);
 
 #endif /* PPU_H */
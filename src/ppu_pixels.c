@@ -0,0 +1,220 @@
+#include "ppu_pixels.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) && !defined(NO_SIMD)
+#define PIXELS_X86 1
+#include <immintrin.h>
+#else
+#define PIXELS_X86 0
+#endif
+
+typedef struct PixelKernels_t {
+	void (*decode_rows)(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows);
+	void (*apply_palette)(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette);
+	void (*pack_pixels)(const uint8_t* colors, uint8_t* packed, uint32_t count);
+} PixelKernels;
+
+static PixelKernels kernels;
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+// Byte i of bit_spread[b] is bit 7 - i of b, so one table load spreads a bitplane
+// byte over a row of 8 pixels and the two planes combine without carries
+static uint64_t bit_spread[256];
+
+// Scalar versions, also used for the tails the vector versions leave
+
+static void decode_rows_scalar(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows){
+	for (uint32_t row = 0; row < rows; row++){
+		uint64_t decoded = bit_spread[bitplanes[row * 2]] | (bit_spread[bitplanes[row * 2 + 1]] << 1);
+		memcpy(&pixels[row * 8], &decoded, 8);
+	}
+}
+
+static void apply_palette_scalar(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette){
+	uint8_t table[4] = {palette & 0x03, (palette >> 2) & 0x03, (palette >> 4) & 0x03, palette >> 6};
+	for (uint32_t i = 0; i < count; i++){
+		colors[i] = table[indices[i]];
+	}
+}
+
+static void pack_pixels_scalar(const uint8_t* colors, uint8_t* packed, uint32_t count){
+	for (uint32_t i = 0; i < count; i += 4){
+		packed[i / 4] = colors[i] | (colors[i + 1] << 2) | (colors[i + 2] << 4) | (colors[i + 3] << 6);
+	}
+}
+
+#if PIXELS_X86
+
+// SSE2 is part of x86-64, these need no check
+
+// Two rows from a vector holding (low, high) bitplane bytes each repeated 4 times
+// in its first 16 bytes, row 0 then row 1. Returns their 16 pixels.
+static inline __m128i decode_two_rows_sse2(__m128i planes){
+	const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+	const __m128i weights = _mm_set_epi8(2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1);
+	__m128i rows[2] = {_mm_unpacklo_epi32(planes, planes), _mm_unpackhi_epi32(planes, planes)};
+
+	for (int i = 0; i < 2; i++){
+		// Low plane byte in the first 8 lanes, high plane byte in the last 8
+		__m128i set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(rows[i], bits), bits), weights);
+		rows[i] = _mm_or_si128(set, _mm_srli_si128(set, 8));
+	}
+	return _mm_unpacklo_epi64(rows[0], rows[1]);
+}
+
+static void decode_rows_sse2(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows){
+	uint32_t row = 0;
+	for (; row + 8 <= rows; row += 8){
+		__m128i planes = _mm_loadu_si128((const __m128i*) &bitplanes[row * 2]);
+		__m128i low = _mm_unpacklo_epi8(planes, planes);   // Rows 0-3, bytes doubled
+		__m128i high = _mm_unpackhi_epi8(planes, planes);  // Rows 4-7
+		_mm_storeu_si128((__m128i*) &pixels[row * 8], decode_two_rows_sse2(_mm_unpacklo_epi16(low, low)));
+		_mm_storeu_si128((__m128i*) &pixels[row * 8 + 16], decode_two_rows_sse2(_mm_unpackhi_epi16(low, low)));
+		_mm_storeu_si128((__m128i*) &pixels[row * 8 + 32], decode_two_rows_sse2(_mm_unpacklo_epi16(high, high)));
+		_mm_storeu_si128((__m128i*) &pixels[row * 8 + 48], decode_two_rows_sse2(_mm_unpackhi_epi16(high, high)));
+	}
+	decode_rows_scalar(&bitplanes[row * 2], &pixels[row * 8], rows - row);
+}
+
+// Without a byte shuffle, each lane picks its color with compares
+static void apply_palette_sse2(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette){
+	__m128i index_values[4];
+	__m128i palette_colors[4];
+	for (int color_num = 0; color_num < 4; color_num++){
+		index_values[color_num] = _mm_set1_epi8(color_num);
+		palette_colors[color_num] = _mm_set1_epi8((palette >> (color_num * 2)) & 0x03);
+	}
+
+	uint32_t i = 0;
+	for (; i + 16 <= count; i += 16){
+		__m128i index = _mm_loadu_si128((const __m128i*) &indices[i]);
+		__m128i color = _mm_setzero_si128();
+		for (int color_num = 0; color_num < 4; color_num++){
+			color = _mm_or_si128(color, _mm_and_si128(_mm_cmpeq_epi8(index, index_values[color_num]), palette_colors[color_num]));
+		}
+		_mm_storeu_si128((__m128i*) &colors[i], color);
+	}
+	apply_palette_scalar(&indices[i], &colors[i], count - i, palette);
+}
+
+// Each 32 bit lane holds 4 colors of 2 bits in separate bytes. Two shift-and-or
+// steps gather them into the low byte, then the lanes are narrowed to bytes.
+static inline __m128i pack_lanes_sse2(__m128i lanes){
+	lanes = _mm_or_si128(lanes, _mm_srli_epi32(lanes, 6));
+	lanes = _mm_or_si128(lanes, _mm_srli_epi32(lanes, 12));
+	return _mm_and_si128(lanes, _mm_set1_epi32(0xFF));
+}
+
+static void pack_pixels_sse2(const uint8_t* colors, uint8_t* packed, uint32_t count){
+	uint32_t i = 0;
+	for (; i + 32 <= count; i += 32){
+		__m128i first = pack_lanes_sse2(_mm_loadu_si128((const __m128i*) &colors[i]));
+		__m128i second = pack_lanes_sse2(_mm_loadu_si128((const __m128i*) &colors[i + 16]));
+		__m128i words = _mm_packs_epi32(first, second);
+		_mm_storel_epi64((__m128i*) &packed[i / 4], _mm_packus_epi16(words, words));
+	}
+	pack_pixels_scalar(&colors[i], &packed[i / 4], count - i);
+}
+
+// AVX2 versions, only called after checking the CPU has it. They clear the upper
+// register halves before handing the tail to the SSE2 versions: the compiler
+// leaves that out of tail calls, and legacy SSE code running with dirty upper
+// halves pays a state transition penalty on every instruction.
+
+__attribute__((target("avx2")))
+static inline __m256i decode_two_rows_avx2(__m256i planes){
+	const __m256i bits = _mm256_broadcastsi128_si256(_mm_set_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128));
+	const __m256i weights = _mm256_broadcastsi128_si256(_mm_set_epi8(2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1));
+	__m256i rows[2] = {_mm256_unpacklo_epi32(planes, planes), _mm256_unpackhi_epi32(planes, planes)};
+
+	for (int i = 0; i < 2; i++){
+		__m256i set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(rows[i], bits), bits), weights);
+		rows[i] = _mm256_or_si256(set, _mm256_srli_si256(set, 8));
+	}
+	return _mm256_unpacklo_epi64(rows[0], rows[1]);
+}
+
+// Unpacks work within 128 bit halves: the low half decodes rows 0-7 and the high
+// half rows 8-15, two rows of each at a time
+__attribute__((target("avx2")))
+static void decode_rows_avx2(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows){
+	uint32_t row = 0;
+	for (; row + 16 <= rows; row += 16){
+		__m256i planes = _mm256_loadu_si256((const __m256i*) &bitplanes[row * 2]);
+		__m256i low = _mm256_unpacklo_epi8(planes, planes);
+		__m256i high = _mm256_unpackhi_epi8(planes, planes);
+		__m256i decoded[4] = {
+			decode_two_rows_avx2(_mm256_unpacklo_epi16(low, low)),
+			decode_two_rows_avx2(_mm256_unpackhi_epi16(low, low)),
+			decode_two_rows_avx2(_mm256_unpacklo_epi16(high, high)),
+			decode_two_rows_avx2(_mm256_unpackhi_epi16(high, high)),
+		};
+		for (int i = 0; i < 4; i++){
+			_mm_storeu_si128((__m128i*) &pixels[row * 8 + i * 16], _mm256_castsi256_si128(decoded[i]));
+			_mm_storeu_si128((__m128i*) &pixels[row * 8 + 64 + i * 16], _mm256_extracti128_si256(decoded[i], 1));
+		}
+	}
+	_mm256_zeroupper();
+	decode_rows_sse2(&bitplanes[row * 2], &pixels[row * 8], rows - row);
+}
+
+// Color indices are 0-3, so they select straight from a table of the 4 colors
+__attribute__((target("avx2")))
+static void apply_palette_avx2(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette){
+	const __m256i table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+		palette & 0x03, (palette >> 2) & 0x03, (palette >> 4) & 0x03, palette >> 6,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+
+	uint32_t i = 0;
+	for (; i + 32 <= count; i += 32){
+		__m256i index = _mm256_loadu_si256((const __m256i*) &indices[i]);
+		_mm256_storeu_si256((__m256i*) &colors[i], _mm256_shuffle_epi8(table, index));
+	}
+	_mm256_zeroupper();
+	apply_palette_sse2(&indices[i], &colors[i], count - i, palette);
+}
+
+#endif /* PIXELS_X86 */
+
+static void select_kernels(void){
+	for (int byte = 0; byte < 256; byte++){
+		uint8_t spread[8];
+		for (int x = 0; x < 8; x++){
+			spread[x] = (byte >> (7 - x)) & 1;
+		}
+		memcpy(&bit_spread[byte], spread, 8);
+	}
+
+	kernels = (PixelKernels){decode_rows_scalar, apply_palette_scalar, pack_pixels_scalar};
+#if PIXELS_X86
+	kernels = (PixelKernels){decode_rows_sse2, apply_palette_sse2, pack_pixels_sse2};
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")){
+		// Packing 160 pixels is a handful of SSE2 steps, AVX2 gains nothing there
+		kernels.decode_rows = decode_rows_avx2;
+		kernels.apply_palette = apply_palette_avx2;
+	}
+#endif
+}
+
+void ppu_pixels_init(void){
+	pthread_once(&kernels_once, select_kernels);
+}
+
+void ppu_decode_rows(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows){
+	// Single VRAM writes decode one row, not worth a trip through the vector code
+	if (rows < 8){
+		decode_rows_scalar(bitplanes, pixels, rows);
+		return;
+	}
+	kernels.decode_rows(bitplanes, pixels, rows);
+}
+
+void ppu_apply_palette(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette){
+	kernels.apply_palette(indices, colors, count, palette);
+}
+
+void ppu_pack_pixels(const uint8_t* colors, uint8_t* packed, uint32_t count){
+	kernels.pack_pixels(colors, packed, count);
+}
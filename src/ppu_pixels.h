@@ -0,0 +1,27 @@
+#ifndef PPU_PIXELS_H
+#define PPU_PIXELS_H
+
+#include <stdint.h>
+
+// Pixel kernels behind the PPU's hot loops, with one implementation per
+// instruction set picked at run time by ppu_pixels_init():
+//  - AVX2 on x86-64 hosts that have it, SSE2 on every other x86-64 host
+//  - A portable scalar version built on lookup tables everywhere else, or when
+//    built with SIMD=0 (defines NO_SIMD)
+// All of them produce exactly the same bytes.
+
+// Selects the kernels for this host. Cheap and safe to call from several threads,
+// initialize_ppu() calls it.
+void ppu_pixels_init(void);
+
+// Decodes rows of interleaved bitplanes (low byte, high byte) to 8 color indices
+// (0-3) each, leftmost pixel first
+void ppu_decode_rows(const uint8_t* bitplanes, uint8_t* pixels, uint32_t rows);
+
+// Maps color indices (0-3) through a palette register (BGP, OBP0, OBP1)
+void ppu_apply_palette(const uint8_t* indices, uint8_t* colors, uint32_t count, uint8_t palette);
+
+// Packs colors 4 to a byte, leftmost in the low bits. count is a multiple of 4.
+void ppu_pack_pixels(const uint8_t* colors, uint8_t* packed, uint32_t count);
+
+#endif /* PPU_PIXELS_H */
@@ -0,0 +1,280 @@
+// Ahead-of-time recompiler: walks the code reachable from the entry point, the
+// restart vectors and the interrupt vectors of a ROM and writes a C file with one
+// function per basic block. Build the emulator with it using make AOT=<file>, see
+// src/aot.h for the runtime side.
+//
+// Blocks are decoded exactly like block_build() does for ROM code. Successors are
+// followed through fall-through, JR/JP/CALL/RST targets and call returns. Targets of
+// JP HL and RET are not known statically and are left to the interpreter. So is any
+// code outside 0x0000-0x7FFF.
+//
+// Code at 0x4000-0x7FFF stays in its own bank. Which bank code in bank 0 reaches
+// there depends on the bank controller at run time, so such targets are translated
+// in every switchable bank; blocks that never run are just never looked up.
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "cpu.h"
+
+#define ROM_LIMIT 0x8000
+#define BANK_SIZE 0x4000           // Same as ROM_BANK_SIZE in mbc.h
+#define MAX_BLOCK_INSTRUCTIONS 16  // Same as BLOCK_MAX_INSTRUCTIONS in block_cache.h
+
+typedef struct RecompiledInstruction_t {
+	const Instruction* instruction;
+	uint16_t pc;
+	uint8_t opcode;
+	uint8_t prefix;
+	uint16_t operand;
+} RecompiledInstruction;
+
+typedef struct Recompiler_t {
+	uint8_t* rom;        // Whole image, padded to whole banks
+	uint32_t banks;
+	uint8_t* queued;     // Per ROM offset: block start already pushed on the work list
+	uint8_t* is_block;   // Per ROM offset: block start with a translation
+	uint32_t* work;      // ROM offsets
+	uint32_t work_count;
+} Recompiler;
+
+// Bank of a ROM offset as block_code_bank() reports it, and the address it runs at
+static inline uint16_t offset_bank(uint32_t offset){
+	return offset / BANK_SIZE;
+}
+
+static inline uint16_t offset_addr(uint32_t offset){
+	return offset < BANK_SIZE ? offset : BANK_SIZE + offset % BANK_SIZE;
+}
+
+static void queue_offset(Recompiler* recompiler, uint32_t offset){
+	if (recompiler->queued[offset]){
+		return;
+	}
+	recompiler->queued[offset] = 1;
+	recompiler->work[recompiler->work_count++] = offset;
+}
+
+// Queues a jump target of code running in bank. Targets at 0x4000-0x7FFF reached
+// from bank 0 may run in any switchable bank.
+static void queue_block(Recompiler* recompiler, uint16_t bank, uint32_t addr){
+	if (addr >= ROM_LIMIT){
+		return;
+	}
+	if (addr < BANK_SIZE){
+		queue_offset(recompiler, addr);
+	} else if (bank > 0){
+		queue_offset(recompiler, bank * BANK_SIZE + addr - BANK_SIZE);
+	} else {
+		for (uint32_t switchable = 1; switchable < recompiler->banks; switchable++){
+			queue_offset(recompiler, switchable * BANK_SIZE + addr - BANK_SIZE);
+		}
+	}
+}
+
+// Decodes the block at a ROM offset, returns the number of instructions or 0 when the
+// block cannot be translated. next is set to the address after the last instruction.
+static int decode_block(Recompiler* recompiler, uint32_t offset, RecompiledInstruction block[MAX_BLOCK_INSTRUCTIONS], uint32_t* next){
+	uint16_t start = offset_addr(offset);
+	uint32_t pc = start;
+	const uint8_t* code = recompiler->rom + offset - start;  // code[pc] for pc in the block's bank
+	int count = 0;
+
+	while (count < MAX_BLOCK_INSTRUCTIONS){
+		if (pc / BANK_SIZE != start / BANK_SIZE){
+			break;
+		}
+
+		uint8_t opcode = code[pc];
+		uint8_t prefix = 0;
+		if (opcode == 0xCB){
+			if ((pc + 1) / BANK_SIZE != start / BANK_SIZE){
+				break;
+			}
+			prefix = 1;
+			opcode = code[pc + 1];
+		}
+
+		const Instruction* instruction = lookup_instruction(prefix, opcode);
+		if (!instruction->execute){
+			break;
+		}
+
+		// Same boundary rule as block_build(): stop before an instruction reaching
+		// into the next 16K, which may be another bank
+		uint32_t length = prefix + instruction->parLength + 1;
+		if ((pc + length - 1) / BANK_SIZE != start / BANK_SIZE){
+			break;
+		}
+
+		RecompiledInstruction* decoded = &block[count++];
+		decoded->instruction = instruction;
+		decoded->pc = pc;
+		decoded->opcode = opcode;
+		decoded->prefix = prefix;
+		switch (instruction->parLength){
+			case 1: decoded->operand = code[pc + prefix + 1]; break;
+			case 2: decoded->operand = code[pc + prefix + 1] | (code[pc + prefix + 2] << 8); break;
+			default: decoded->operand = 0; break;
+		}
+		pc += length;
+
+		if (!prefix && block_ends_with(opcode)){
+			break;
+		}
+	}
+
+	*next = pc;
+	return count;
+}
+
+// Queues every statically known successor of a decoded block
+static void queue_successors(Recompiler* recompiler, uint16_t bank, RecompiledInstruction* last, int count, uint32_t next){
+	if (last->prefix || !block_ends_with(last->opcode)){
+		if (count == MAX_BLOCK_INSTRUCTIONS || next % BANK_SIZE == 0){
+			queue_block(recompiler, bank, next);  // Split by the size limit or a bank boundary
+		}
+		return;  // Otherwise stopped before an unimplemented opcode
+	}
+
+	switch (last->opcode){
+		case 0x18:
+			queue_block(recompiler, bank, (uint16_t)(next + (int8_t)last->operand));
+			return;
+		case 0x20: case 0x28: case 0x30: case 0x38:
+			queue_block(recompiler, bank, (uint16_t)(next + (int8_t)last->operand));
+			queue_block(recompiler, bank, next);
+			return;
+		case 0xC3:
+			queue_block(recompiler, bank, last->operand);
+			return;
+		case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+		case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+			queue_block(recompiler, bank, last->operand);
+			queue_block(recompiler, bank, next);
+			return;
+		case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+		case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+			queue_block(recompiler, bank, last->opcode & 0x38);
+			queue_block(recompiler, bank, next);
+			return;
+		case 0xE9: case 0xC9: case 0xD9:
+			return;  // Computed targets
+		default:
+			// Conditional returns, HALT, STOP, DI, EI
+			queue_block(recompiler, bank, next);
+			return;
+	}
+}
+
+static void write_block(FILE* out, uint16_t bank, RecompiledInstruction* block, int count){
+	fprintf(out, "static uint16_t aot_%03x_%04x(Cpu* cpu, Interconnect* interconnect){\n", bank, block[0].pc);
+	fprintf(out, "\tAOT_BEGIN();\n");
+
+	for (int i = 0; i < count; i++){
+		RecompiledInstruction* decoded = &block[i];
+		char disassembly[64];
+		snprintf(disassembly, sizeof(disassembly), decoded->instruction->disassembly, decoded->operand);
+
+		fprintf(out, "\t%s(0x%04x, opCode0x%s%02x, 0x%04x, %u, %d, %u);  // %s\n",
+			i == count - 1 ? "AOT_LAST" : "AOT_STEP",
+			decoded->pc, decoded->prefix ? "cb" : "", decoded->opcode, decoded->operand,
+			decoded->prefix, decoded->instruction->parLength + 1, decoded->instruction->cycles,
+			disassembly);
+	}
+	fprintf(out, "}\n\n");
+}
+
+int main(int argc, const char* argv[]){
+	if (argc != 3){
+		fprintf(stderr, "Usage: %s <rom_file> <output.c>\n", argv[0]);
+		fprintf(stderr, "Then build the emulator with 'make AOT=<output.c>'\n");
+		return 1;
+	}
+
+	uint64_t romFileLen = 0;
+	unsigned char* rom = NULL;
+	if (read_from_disk(argv[1], &romFileLen, &rom)){
+		return 1;
+	}
+
+	// Pad to whole banks, the emulator reads 0xFF past the end of the image
+	Recompiler* recompiler = (Recompiler*) calloc(1, sizeof(Recompiler));
+	recompiler->banks = (romFileLen + BANK_SIZE - 1) / BANK_SIZE;
+	if (recompiler->banks < 2){
+		recompiler->banks = 2;
+	}
+	uint32_t rom_limit = recompiler->banks * BANK_SIZE;
+	recompiler->rom = (uint8_t*) malloc(rom_limit);
+	memset(recompiler->rom, 0xFF, rom_limit);
+	memcpy(recompiler->rom, rom, romFileLen);
+	recompiler->queued = (uint8_t*) calloc(rom_limit, 1);
+	recompiler->is_block = (uint8_t*) calloc(rom_limit, 1);
+	recompiler->work = (uint32_t*) malloc(rom_limit * sizeof(uint32_t));
+
+	// Entry point, RST vectors and interrupt vectors
+	queue_block(recompiler, 0, 0x100);
+	for (uint16_t vector = 0x00; vector <= 0x60; vector += 0x08){
+		queue_block(recompiler, 0, vector);
+	}
+
+	RecompiledInstruction block[MAX_BLOCK_INSTRUCTIONS];
+	uint32_t block_count = 0;
+	while (recompiler->work_count > 0){
+		uint32_t offset = recompiler->work[--recompiler->work_count];
+		uint32_t next;
+		int count = decode_block(recompiler, offset, block, &next);
+		if (count == 0){
+			continue;
+		}
+		recompiler->is_block[offset] = 1;
+		block_count++;
+		queue_successors(recompiler, offset_bank(offset), &block[count - 1], count, next);
+	}
+
+	if (block_count == 0){
+		fprintf(stderr, "No translatable code found in %s\n", argv[1]);
+		return 1;
+	}
+
+	FILE* out = fopen(argv[2], "w");
+	if (!out){
+		fprintf(stderr, "unable to open %s for writing!\n", argv[2]);
+		return 1;
+	}
+
+	fprintf(out, "// Generated by recompile from %s, do not edit.\n", argv[1]);
+	fprintf(out, "// %" PRIu32 " blocks, build with: make AOT=%s\n\n", block_count, argv[2]);
+	fprintf(out, "#define AOT_ROM_HASH 0x%016" PRIx64 "ULL\n\n", hash_bytes(rom, romFileLen));
+	free(rom);
+
+	for (uint32_t offset = 0; offset < rom_limit; offset++){
+		if (recompiler->is_block[offset]){
+			uint32_t next;
+			int count = decode_block(recompiler, offset, block, &next);
+			write_block(out, offset_bank(offset), block, count);
+		}
+	}
+
+	// Sorted by start then bank, bank follows block_code_bank()
+	fprintf(out, "static const AotBlock aot_blocks[] = {\n");
+	for (uint32_t addr = 0; addr < ROM_LIMIT; addr++){
+		uint32_t first_bank = addr < BANK_SIZE ? 0 : 1;
+		uint32_t last_bank = addr < BANK_SIZE ? 0 : recompiler->banks - 1;
+		for (uint32_t bank = first_bank; bank <= last_bank; bank++){
+			uint32_t offset = bank * BANK_SIZE + addr % BANK_SIZE;
+			if (recompiler->is_block[offset]){
+				uint32_t next;
+				int count = decode_block(recompiler, offset, block, &next);
+				fprintf(out, "\t{0x%04x, %u, %d, aot_%03x_%04x},\n", addr, bank, count, bank, addr);
+			}
+		}
+	}
+	fprintf(out, "};\n");
+	fclose(out);
+
+	fprintf(stderr, "%" PRIu32 " blocks written to %s\n", block_count, argv[2]);
+	return 0;
+}
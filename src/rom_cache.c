@@ -0,0 +1,78 @@
+#include "rom_cache.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "util.h"
+
+typedef struct RomImage_t {
+	const unsigned char* data;
+	uint64_t length;
+	uint64_t hash;
+} RomImage;
+
+static RomImage rom_images[ROM_CACHE_ENTRIES];
+static int rom_image_count = 0;
+static pthread_mutex_t rom_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Maps a whole file read-only, NULL on failure
+static const unsigned char* map_file(const char* path, uint64_t* length){
+	int fd = open(path, O_RDONLY);
+	if (fd < 0){
+		fprintf(stderr, "unable to open ROM file %s!\n", path);
+		return NULL;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0){
+		fprintf(stderr, "unable to map empty or unreadable ROM file %s!\n", path);
+		close(fd);
+		return NULL;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void* data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED){
+		fprintf(stderr, "unable to map ROM file %s!\n", path);
+		return NULL;
+	}
+
+	*length = (uint64_t) info.st_size;
+	return (const unsigned char*) data;
+}
+
+const unsigned char* rom_cache_open(const char* path, uint64_t* length){
+	uint64_t mapped_length = 0;
+	const unsigned char* data = map_file(path, &mapped_length);
+	if (!data){
+		return NULL;
+	}
+	uint64_t hash = hash_bytes(data, mapped_length);
+
+	pthread_mutex_lock(&rom_cache_lock);
+	for (int i = 0; i < rom_image_count; i++){
+		RomImage* image = &rom_images[i];
+		if (image->hash == hash && image->length == mapped_length &&
+		    memcmp(image->data, data, mapped_length) == 0){
+			// Same cartridge already mapped, drop the new mapping
+			pthread_mutex_unlock(&rom_cache_lock);
+			munmap((void*) data, mapped_length);
+			*length = image->length;
+			return image->data;
+		}
+	}
+
+	// A full cache still returns the mapping, it just is not shared
+	if (rom_image_count < ROM_CACHE_ENTRIES){
+		rom_images[rom_image_count++] = (RomImage){data, mapped_length, hash};
+	}
+	pthread_mutex_unlock(&rom_cache_lock);
+
+	fprintf(stdout, "successfully mapped ROM file %s\n", path);
+	*length = mapped_length;
+	return data;
+}
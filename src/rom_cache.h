@@ -0,0 +1,18 @@
+#ifndef ROM_CACHE_H
+#define ROM_CACHE_H
+
+#include <stdint.h>
+
+// Process-wide cache of read-only ROM images. Files are mapped with
+// mmap(PROT_READ) instead of being read into the heap, and the mapping is used
+// directly by the memory map (see load_cartridge_rom). Images are keyed by
+// content hash, so every machine running the same cartridge, even when loaded
+// from different paths, shares one mapping. Mappings live until the process
+// exits.
+#define ROM_CACHE_ENTRIES 64
+
+// Returns the image of the file at path and its length, or NULL if it cannot be
+// mapped. Safe to call from several threads.
+const unsigned char* rom_cache_open(const char* path, uint64_t* length);
+
+#endif /* ROM_CACHE_H */
@@ -0,0 +1,42 @@
+#include "save_file.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint8_t* save_file_open(const char* path, uint32_t size){
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0){
+		fprintf(stderr, "unable to open save file %s!\n", path);
+		return NULL;
+	}
+
+	// New or short files are extended with zeros, longer ones keep their tail
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (info.st_size < (off_t) size && ftruncate(fd, size) != 0)){
+		fprintf(stderr, "unable to size save file %s!\n", path);
+		close(fd);
+		return NULL;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED){
+		fprintf(stderr, "unable to map save file %s!\n", path);
+		return NULL;
+	}
+
+	fprintf(stdout, "successfully mapped save file %s\n", path);
+	return (uint8_t*) data;
+}
+
+void save_file_flush(uint8_t* data, uint32_t size){
+	msync(data, size, MS_ASYNC);
+}
+
+void save_file_close(uint8_t* data, uint32_t size){
+	msync(data, size, MS_SYNC);
+	munmap(data, size);
+}
@@ -0,0 +1,21 @@
+#ifndef SAVE_FILE_H
+#define SAVE_FILE_H
+
+#include <stdint.h>
+
+// Battery-backed cartridge RAM kept in a .sav file mapped with mmap(MAP_SHARED).
+// The emulated machine writes straight into the mapping through the memory map,
+// so there is no separate write-out pass and a crash loses nothing the kernel
+// already has. Flushing to disk (msync) is batched, see flush_cartridge_ram().
+
+// Maps the file at path as size bytes of RAM, creating or growing it as needed.
+// Returns NULL if it cannot be mapped.
+uint8_t* save_file_open(const char* path, uint32_t size);
+
+// Starts writing back the pages written since the last flush, does not block
+void save_file_flush(uint8_t* data, uint32_t size);
+
+// Writes everything back, waits for it, and unmaps the file
+void save_file_close(uint8_t* data, uint32_t size);
+
+#endif /* SAVE_FILE_H */
@@ -0,0 +1,107 @@
+#include "scheduler.h"
+#include <string.h>
+
+void initialize_scheduler(Scheduler* scheduler){
+	memset(scheduler, 0, sizeof(Scheduler));
+	scheduler->next_deadline = SCHEDULER_NEVER;
+	for (int i = 0; i < EVENT_COUNT; i++){
+		scheduler->slot[i] = -1;
+	}
+}
+
+static void heap_swap(Scheduler* scheduler, int a, int b){
+	Event temp = scheduler->heap[a];
+	scheduler->heap[a] = scheduler->heap[b];
+	scheduler->heap[b] = temp;
+	scheduler->slot[scheduler->heap[a].type] = a;
+	scheduler->slot[scheduler->heap[b].type] = b;
+}
+
+static void sift_up(Scheduler* scheduler, int i){
+	while (i > 0){
+		int parent = (i - 1) / 2;
+		if (scheduler->heap[parent].deadline <= scheduler->heap[i].deadline){
+			break;
+		}
+		heap_swap(scheduler, i, parent);
+		i = parent;
+	}
+}
+
+static void sift_down(Scheduler* scheduler, int i){
+	for (;;){
+		int left = 2 * i + 1;
+		int right = left + 1;
+		int smallest = i;
+
+		if (left < scheduler->size && scheduler->heap[left].deadline < scheduler->heap[smallest].deadline){
+			smallest = left;
+		}
+		if (right < scheduler->size && scheduler->heap[right].deadline < scheduler->heap[smallest].deadline){
+			smallest = right;
+		}
+		if (smallest == i){
+			break;
+		}
+		heap_swap(scheduler, i, smallest);
+		i = smallest;
+	}
+}
+
+static void update_next_deadline(Scheduler* scheduler){
+	scheduler->next_deadline = scheduler->size ? scheduler->heap[0].deadline : SCHEDULER_NEVER;
+}
+
+void scheduler_schedule(Scheduler* scheduler, uint8_t type, uint64_t deadline){
+	int i = scheduler->slot[type];
+
+	if (i < 0){
+		// New event, append and restore heap order
+		i = scheduler->size++;
+		scheduler->heap[i].deadline = deadline;
+		scheduler->heap[i].type = type;
+		scheduler->slot[type] = i;
+		sift_up(scheduler, i);
+	} else {
+		// Already pending, move it to its new position
+		uint64_t old_deadline = scheduler->heap[i].deadline;
+		scheduler->heap[i].deadline = deadline;
+		if (deadline < old_deadline){
+			sift_up(scheduler, i);
+		} else {
+			sift_down(scheduler, i);
+		}
+	}
+
+	update_next_deadline(scheduler);
+}
+
+void scheduler_cancel(Scheduler* scheduler, uint8_t type){
+	int i = scheduler->slot[type];
+	if (i < 0){
+		return;
+	}
+
+	int last = --scheduler->size;
+	if (i != last){
+		heap_swap(scheduler, i, last);
+	}
+	scheduler->slot[type] = -1;
+
+	if (i < scheduler->size){
+		sift_down(scheduler, i);
+		sift_up(scheduler, i);
+	}
+
+	update_next_deadline(scheduler);
+}
+
+int scheduler_pop_due(Scheduler* scheduler, Event* event){
+	if (scheduler->size == 0 || scheduler->heap[0].deadline > scheduler->now){
+		return 0;
+	}
+
+	*event = scheduler->heap[0];
+	scheduler_cancel(scheduler, event->type);
+	return 1;
+}
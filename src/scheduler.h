@@ -0,0 +1,38 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// Event types, at most one pending event per type
+#define EVENT_PPU    0  // Next PPU mode transition
+#define EVENT_TIMER  1  // TIMA overflow
+#define EVENT_FRAME  2  // Frame pacing boundary
+#define EVENT_SAVE   3  // Periodic flush of the save file
+#define EVENT_DMA    4  // End of an OAM DMA transfer
+#define EVENT_COUNT  5
+
+#define SCHEDULER_NEVER UINT64_MAX
+
+typedef struct Event_t {
+	uint64_t deadline;  // Timestamp in T-cycles
+	uint8_t type;       // EVENT_*
+} Event;
+
+typedef struct Scheduler_t {
+	uint64_t now;                // Global timestamp in T-cycles
+	uint64_t next_deadline;      // Earliest pending deadline, SCHEDULER_NEVER if none
+	Event heap[EVENT_COUNT];     // Min-heap ordered by deadline
+	uint8_t size;
+	int8_t slot[EVENT_COUNT];    // Heap index per event type, -1 when not scheduled
+} Scheduler;
+
+void initialize_scheduler(Scheduler* scheduler);
+
+// Schedules (or reschedules) the event of the given type
+void scheduler_schedule(Scheduler* scheduler, uint8_t type, uint64_t deadline);
+void scheduler_cancel(Scheduler* scheduler, uint8_t type);
+
+// Removes the earliest event whose deadline has passed, returns 0 if none is due
+int scheduler_pop_due(Scheduler* scheduler, Event* event);
+
+#endif /* SCHEDULER_H */
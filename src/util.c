@@ -34,3 +34,13 @@ int32_t read_from_disk(const char* path, uint64_t* length, unsigned char* rom[])
 	return 0;
 }
 
+
+// 64-bit FNV-1a, used to identify ROM images
+uint64_t hash_bytes(const uint8_t* data, uint64_t length){
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (uint64_t i = 0; i < length; i++){
+		hash ^= data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
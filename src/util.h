@@ -16,5 +16,6 @@
         do { if (DEBUG_PRINT) fprintf(stderr, "%s:%d:%s(): " fmt, __FILE__, \
                                 __LINE__, __func__, __VA_ARGS__); } while (0)
 int32_t read_from_disk(const char* path, uint64_t* length, unsigned char* rom[]);
+uint64_t hash_bytes(const uint8_t* data, uint64_t length);
 
 #endif /* UTIL_H */
@@ -39,8 +39,7 @@ void run_video_loop(Video* video){
 			Color* pixels = (Color*)malloc(GB_SCREEN_WIDTH * GB_SCREEN_HEIGHT * sizeof(Color));
 			for (int y = 0; y < GB_SCREEN_HEIGHT; y++){
 				for (int x = 0; x < GB_SCREEN_WIDTH; x++){
-					uint8_t color_index = video->ppu->framebuffer[y * GB_SCREEN_WIDTH + x];
-					pixels[y * GB_SCREEN_WIDTH + x] = dmg_palette[color_index & 0x03];
+					pixels[y * GB_SCREEN_WIDTH + x] = dmg_palette[ppu_pixel(video->ppu, x, y)];
 				}
 			}
 